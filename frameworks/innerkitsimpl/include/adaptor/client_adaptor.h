@@ -16,17 +16,56 @@
 #ifndef OBJECT_CLIENT_ADAPTOR_H
 #define OBJECT_CLIENT_ADAPTOR_H
 
+#include <chrono>
+#include <future>
+#include <mutex>
+
 #include "object_service_proxy.h"
 #include "ikvstore_data_service.h"
+#include "system_ability_status_change_stub.h"
 namespace OHOS::ObjectStore {
 class ClientAdaptor {
 public:
-    static sptr<OHOS::DistributedObject::IObjectService> GetObjectService();
+    static constexpr std::chrono::milliseconds DISCOVERY_TIMEOUT = std::chrono::seconds(3);
+    // looks the data service up in background, later callers only wait for the result
+    static void Prefetch();
+    // the proxy is cached until the service dies, then it is looked up again in background.
+    // a cached proxy found dead is dropped at once, without waiting for the death notification
+    static sptr<OHOS::DistributedObject::IObjectService> GetObjectService(
+        std::chrono::milliseconds timeout = DISCOVERY_TIMEOUT);
 private:
+    using DataManager = sptr<OHOS::DistributedKv::IKvStoreDataService>;
+    class ServiceDeathRecipient : public IRemoteObject::DeathRecipient {
+    public:
+        void OnRemoteDied(const wptr<IRemoteObject> &remote) override;
+    };
+    class ServiceStatusListener : public SystemAbilityStatusChangeStub {
+    public:
+        void OnAddSystemAbility(int32_t systemAbilityId, const std::string &deviceId) override;
+        void OnRemoveSystemAbility(int32_t systemAbilityId, const std::string &deviceId) override;
+    };
     static constexpr int32_t DISTRIBUTED_KV_DATA_SERVICE_ABILITY_ID = 1301;
-    static constexpr int32_t GET_SA_RETRY_TIMES = 3;
-    static constexpr int32_t RETRY_INTERVAL = 1;
-    static sptr<OHOS::DistributedKv::IKvStoreDataService> GetDistributedDataManager();
+    static constexpr int32_t MAX_CHECK_TIMES = 6;
+    static constexpr std::chrono::milliseconds MIN_CHECK_INTERVAL = std::chrono::milliseconds(100);
+    static constexpr std::chrono::milliseconds MAX_CHECK_INTERVAL = std::chrono::seconds(1);
+    static std::shared_future<DataManager> GetReadyFuture();
+    static void Discover();
+    static void OnServiceReady(const sptr<IRemoteObject> &remote);
+    static void ResetObjectService(const wptr<IRemoteObject> &remote);
+    static bool IsDead(const sptr<IRemoteObject> &remote);
+    static std::mutex mutex_;
+    static sptr<OHOS::DistributedObject::IObjectService> objectService_;
+    // bumped when the service dies, a lookup started before that is not cached
+    static uint64_t generation_;
+    static std::mutex discoveryMutex_;
+    static bool isDiscovering_;
+    static bool isReady_;
+    static std::shared_ptr<std::promise<DataManager>> readyPromise_;
+    static std::shared_future<DataManager> readyFuture_;
+    static DataManager distributedDataMgr_;
+    static sptr<IRemoteObject::DeathRecipient> deathRecipient_;
+    static std::once_flag subscribeFlag_;
+    static sptr<ISystemAbilityStatusChange> statusListener_;
 };
 } // namespace OHOS::ObjectStore
 
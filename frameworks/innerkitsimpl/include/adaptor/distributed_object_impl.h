@@ -35,6 +35,7 @@ public:
     uint32_t GetComplex(const std::string &key, std::vector<uint8_t> &value) override;
     std::string &GetSessionId() override;
     uint32_t Save(const std::string &deviceId) override;
+    uint32_t Save(const std::vector<std::string> &deviceIds, std::map<std::string, int32_t> &results) override;
     uint32_t RevokeSave() override;
     uint32_t GetType(const std::string &key, Type &type) override;
 
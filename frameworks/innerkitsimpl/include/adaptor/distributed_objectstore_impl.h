@@ -18,18 +18,15 @@
 
 #include <bytes.h>
 
+#include <mutex>
 #include <shared_mutex>
+#include <unordered_map>
 
 #include "distributed_objectstore.h"
+#include "restore_coordinator.h"
 
 namespace OHOS::ObjectStore {
 class WatcherProxy;
-enum SyncStatus {
-    SYNC_START,
-    SYNCING,
-    SYNC_SUCCESS,
-    SYNC_FAIL,
-};
 class DistributedObjectStoreImpl : public DistributedObjectStore {
 public:
     DistributedObjectStoreImpl(FlatObjectStore *flatObjectStore);
@@ -39,17 +36,27 @@ public:
     uint32_t DeleteObject(const std::string &sessionId) override;
     uint32_t Watch(DistributedObject *object, std::shared_ptr<ObjectWatcher> watcher) override;
     uint32_t UnWatch(DistributedObject *object) override;
+    uint32_t UnWatch(DistributedObject *object, std::shared_ptr<ObjectWatcher> watcher) override;
     uint32_t SetStatusNotifier(std::shared_ptr<StatusNotifier> notifier) override;
+    uint32_t SaveAll(const std::vector<std::string> &sessionIds, const std::string &deviceId,
+        const std::function<void(const std::map<std::string, uint32_t> &results)> &callback) override;
+    uint32_t RetrieveAll(const std::vector<std::string> &sessionIds,
+        const std::function<void(const std::map<std::string, uint32_t> &results)> &callback) override;
     void TriggerSync() override;
+    uint32_t TriggerSync(const std::function<void(const std::map<std::string, uint32_t> &results)> &callback) override;
     void TriggerRestore(std::function<void()> notifier) override;
+    uint32_t TriggerRestore(
+        std::chrono::milliseconds timeout, const std::function<void(uint32_t status)> &notifier) override;
 
 private:
     DistributedObject *CacheObject(const std::string &sessionId, FlatObjectStore *flatObjectStore);
     void RemoveCacheObject(const std::string &sessionId);
     FlatObjectStore *flatObjectStore_ = nullptr;
-    std::map<DistributedObject *, std::shared_ptr<WatcherProxy>> watchers_;
+    std::mutex watcherMutex_{};
+    std::map<DistributedObject *, std::map<ObjectWatcher *, std::shared_ptr<WatcherProxy>>> watchers_;
+    // readers take the shared lock, objects of one session are kept in creation order
     std::shared_mutex dataMutex_{};
-    std::vector<DistributedObject *> objects_{};
+    std::unordered_map<std::string, std::vector<DistributedObject *>> objects_{};
 };
 class StatusNotifierProxy : public StatusWatcher {
 public:
@@ -19,12 +19,29 @@
 #include <cstdint>
 #include <map>
 #include <mutex>
+#include <set>
 #include <vector>
 
+#include "hybrid_logical_clock.h"
 #include "kv_store_delegate_manager.h"
 #include "object_storage_engine.h"
+#include "task_scheduler.h"
 
 namespace OHOS::ObjectStore {
+class FlatObjectStorageEngine;
+// the only DistributedDB observer of a table, resolves concurrent field writes before notifying watchers
+class TableObserver : public Watcher {
+public:
+    TableObserver(const std::string &sessionId, FlatObjectStorageEngine *engine);
+    void OnChanged(const std::string &sessionid, const std::vector<std::string> &changedData) override;
+    bool Accept(const std::string &key, const std::vector<uint8_t> &value,
+        const std::vector<uint8_t> &version) override;
+
+private:
+    std::string sessionId_;
+    FlatObjectStorageEngine *engine_;
+};
+
 class FlatObjectStorageEngine : public ObjectStorageEngine {
 public:
     FlatObjectStorageEngine() = default;
@@ -40,17 +57,58 @@ public:
     uint32_t GetItems(const std::string &key, std::map<std::string, std::vector<uint8_t>> &data) override;
     uint32_t RegisterObserver(const std::string &key, std::shared_ptr<TableWatcher> watcher) override;
     uint32_t UnRegisterObserver(const std::string &key) override;
+    uint32_t UnRegisterObserver(const std::string &key, const std::shared_ptr<TableWatcher> &watcher);
     uint32_t SetStatusNotifier(std::shared_ptr<StatusWatcher> watcher) override;
     uint32_t SyncAllData(const std::string &sessionId, const std::vector<std::string> &deviceIds,
         const std::function<void(const std::map<std::string, DistributedDB::DBStatus> &)> &onComplete);
+    // runs in the DistributedDB callback, keeps a locally written field value a sync overwrites until it is resolved
+    void OnConflict(const std::string &sessionId, const DistributedDB::KvStoreNbConflictData &data);
+    // runs in the DistributedDB callback, a local field that wins is only recorded for WriteBack
+    bool ResolveField(const std::string &sessionId, const std::string &itemKey, const Value &version);
+    // writes the recorded winning fields again on the scheduler, outside the DistributedDB callback
+    void ScheduleWriteBack(const std::string &sessionId);
+    void NotifyChange(const std::string &sessionId, const std::vector<std::string> &changedData);
+    // tables written locally since their last push
+    std::set<std::string> TakeUnsyncedTables();
+    void MarkUnsynced(const std::set<std::string> &keys);
+    // issues the push of every table in one pass, onComplete runs once per table
+    void PushTables(const std::set<std::string> &keys, const std::vector<std::string> &deviceIds,
+        const std::function<void(const std::string &key, uint32_t status)> &onComplete);
     bool isOpened_ = false;
 
 private:
+    // the process label and communicator are process wide, the first store opened sets them up for all stores.
+    // the label is its bundle name as before, so peers see the same identity
+    static uint32_t InitProcess(const std::string &bundleName);
+    // operationMutex_ held, field writes carry a new version, the value itself is stored once
+    uint32_t PutFields(const std::string &key, DistributedDB::KvStoreNbDelegate *delegate,
+        const std::map<std::string, std::vector<uint8_t>> &data);
+    // fieldMutex_ held, the field lost or was rewritten without a version, its overwritten value is not needed
+    void DropOverwritten(const std::string &sessionId, const std::string &itemKey);
+    void WriteBack(const std::string &sessionId);
+    uint32_t PushTable(const std::string &key, const std::vector<std::string> &deviceIds,
+        const std::function<void(const std::string &key, uint32_t status)> &onComplete);
     std::mutex operationMutex_{};
     std::shared_ptr<DistributedDB::KvStoreDelegateManager> storeManager_;
     std::map<std::string, DistributedDB::KvStoreNbDelegate *> delegates_;
-    std::map<std::string, std::shared_ptr<TableWatcher>> observerMap_;
+    using Subscribers = std::vector<std::shared_ptr<TableWatcher>>;
+    // copy on write, a notification only copies the list pointer and runs without the lock
+    std::mutex observerMutex_{};
+    std::map<std::string, std::shared_ptr<const Subscribers>> observerMap_;
     std::shared_ptr<StatusWatcher> statusWatcher_ = nullptr;
+    std::map<std::string, std::shared_ptr<TableObserver>> tableObservers_;
+    // never held while calling DistributedDB, the observer callback only takes this one
+    std::mutex fieldMutex_{};
+    std::map<std::string, FieldVersionTable> fieldVersions_;
+    // values of local fields overwritten by a sync, from the conflict notifier until ResolveField or WriteBack
+    std::map<std::string, std::map<std::string, Value>> overwritten_;
+    std::map<std::string, std::set<std::string>> writeBacks_;
+    // never held while taking operationMutex_, push callbacks only take this one
+    std::mutex syncMutex_{};
+    std::set<std::string> unsyncedTables_;
+    HybridLogicalClock clock_;
+    // last member, joined before the state its tasks use is destroyed
+    TaskScheduler writeBackScheduler_;
 };
 } // namespace OHOS::ObjectStore
 #endif
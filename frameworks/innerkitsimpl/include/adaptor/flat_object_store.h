@@ -16,12 +16,16 @@
 #ifndef FLAT_OBJECT_STORE_H
 #define FLAT_OBJECT_STORE_H
 
+#include <chrono>
 #include <memory>
 #include <string>
 
 #include "bytes.h"
+#include "cancellation_token.h"
 #include "flat_object_storage_engine.h"
 #include "condition_lock.h"
+#include "result_collector.h"
+#include "session_task_queue.h"
 
 namespace OHOS::ObjectStore {
 class FlatObjectWatcher : public TableWatcher {
@@ -34,38 +38,93 @@ public:
 
 class CacheManager {
 public:
+    using SaveCallback = std::function<void(uint32_t status)>;
+    using SaveResultsCallback = std::function<void(const std::map<std::string, int32_t> &results)>;
+    static constexpr std::chrono::milliseconds DEFAULT_WAIT_TIMEOUT = std::chrono::seconds(30);
     CacheManager();
+    // ERR_TIMEOUT if the service does not answer in time, the pending task is cancelled then
     uint32_t Save(const std::string &bundleName, const std::string &sessionId, const std::string &deviceId,
-        const std::map<std::string, std::vector<uint8_t>> &objectData);
-    uint32_t RevokeSave(const std::string &bundleName, const std::string &sessionId);
+        std::map<std::string, std::vector<uint8_t>> objectData,
+        std::chrono::milliseconds timeout = DEFAULT_WAIT_TIMEOUT,
+        std::shared_ptr<CancellationToken> token = nullptr);
+    uint32_t RevokeSave(const std::string &bundleName, const std::string &sessionId,
+        std::chrono::milliseconds timeout = DEFAULT_WAIT_TIMEOUT,
+        std::shared_ptr<CancellationToken> token = nullptr);
+    // callback runs once the service answered, tasks of one session run in order.
+    // a cancelled task answers ERR_CANCELED and frees its place in the session queue
+    void SaveAsync(const std::string &bundleName, const std::string &sessionId, const std::string &deviceId,
+        std::map<std::string, std::vector<uint8_t>> objectData, const SaveCallback &callback,
+        std::shared_ptr<CancellationToken> token = nullptr);
+    void RevokeSaveAsync(const std::string &bundleName, const std::string &sessionId, const SaveCallback &callback,
+        std::shared_ptr<CancellationToken> token = nullptr);
+    // one snapshot sent to every device at once, results are keyed by device id
+    uint32_t Save(const std::string &bundleName, const std::string &sessionId,
+        const std::vector<std::string> &deviceIds, std::map<std::string, std::vector<uint8_t>> objectData,
+        std::map<std::string, int32_t> &results, std::chrono::milliseconds timeout = DEFAULT_WAIT_TIMEOUT);
+    void SaveAsync(const std::string &bundleName, const std::string &sessionId,
+        const std::vector<std::string> &deviceIds, std::map<std::string, std::vector<uint8_t>> objectData,
+        const SaveResultsCallback &callback, std::shared_ptr<CancellationToken> token = nullptr);
     int32_t ResumeObject(const std::string &bundleName, const std::string &sessionId,
                          std::function<void(const std::map<std::string, std::vector<uint8_t>> &data)> &callback);
 private:
+    static SaveCallback ReplyOnce(const SaveCallback &callback, const std::shared_ptr<CancellationToken> &token);
+    static std::function<void()> ReleaseOnce(
+        const std::function<void()> &done, const std::shared_ptr<CancellationToken> &token);
+    static uint32_t WaitResult(const std::string &name, const std::shared_ptr<ConditionLock<uint32_t>> &conditionLock,
+        std::chrono::milliseconds timeout, const std::shared_ptr<CancellationToken> &token);
     int32_t SaveObject(const std::string &bundleName, const std::string &sessionId,
         const std::string &deviceId, const std::map<std::string, std::vector<uint8_t>> &objectData,
         const std::function<void(const std::map<std::string, int32_t> &)> &callback);
     int32_t RevokeSaveObject(
         const std::string &bundleName, const std::string &sessionId, std::function<void(int32_t)> &callback);
-    std::mutex mutex_;
+    SessionTaskQueue taskQueue_;
 };
 
 class FlatObjectStore {
 public:
+    using BatchCallback = std::function<void(const std::map<std::string, uint32_t> &results)>;
     explicit FlatObjectStore(const std::string &bundleName);
     ~FlatObjectStore();
     uint32_t CreateObject(const std::string &sessionId);
     uint32_t Delete(const std::string &objectId);
     uint32_t Watch(const std::string &objectId, std::shared_ptr<FlatObjectWatcher> watcher);
     uint32_t UnWatch(const std::string &objectId);
+    uint32_t UnWatch(const std::string &objectId, const std::shared_ptr<FlatObjectWatcher> &watcher);
     uint32_t Put(const std::string &sessionId, const std::string &key, std::vector<uint8_t> value);
     uint32_t Get(std::string &sessionId, const std::string &key, Bytes &value);
     uint32_t SetStatusNotifier(std::shared_ptr<StatusWatcher> sharedPtr);
     uint32_t SyncAllData(const std::string &sessionId,
         const std::function<void(const std::map<std::string, DistributedDB::DBStatus> &)> &onComplete);
     uint32_t Save(const std::string &sessionId, const std::string &deviceId);
+    uint32_t Save(const std::string &sessionId, const std::vector<std::string> &deviceIds,
+        std::map<std::string, int32_t> &results);
+    void SaveAsync(
+        const std::string &sessionId, const std::string &deviceId, const CacheManager::SaveCallback &callback);
     uint32_t RevokeSave(const std::string &sessionId);
+    // every session is saved or retrieved concurrently, the callback runs once all of them are answered
+    void SaveAll(const std::vector<std::string> &sessionIds, const std::string &deviceId,
+        const BatchCallback &callback);
+    void RetrieveAll(const std::vector<std::string> &sessionIds, const BatchCallback &callback);
+    void RetrieveAsync(const std::string &sessionId, const CacheManager::SaveCallback &callback);
+    // one pass pushing every locally changed session to all online devices, failed sessions stay unsynced
+    void PushAll(const BatchCallback &callback);
 
 private:
+    // started by the first access of the session, an abandoned retrieve drops whatever arrives later
+    struct RetrieveState {
+        std::mutex mutex;
+        bool isStarted = false; // guarded by retrieveMutex_
+        bool isAbandoned = false;
+        ConditionLock<uint32_t> retrieved;
+    };
+    static constexpr std::chrono::milliseconds RETRIEVE_WAIT_TIMEOUT = std::chrono::seconds(3);
+    void WaitRetrieved(const std::string &sessionId);
+    void StartRetrieve(const std::string &sessionId, const std::shared_ptr<RetrieveState> &state);
+    static void Abandon(const std::shared_ptr<RetrieveState> &state);
+    static uint32_t ApplyRetrieved(const std::shared_ptr<FlatObjectStorageEngine> &storageEngine,
+        const std::string &sessionId, const std::map<std::string, std::vector<uint8_t>> &data);
+    std::mutex retrieveMutex_;
+    std::map<std::string, std::shared_ptr<RetrieveState>> pendingRetrieves_;
     std::shared_ptr<FlatObjectStorageEngine> storageEngine_;
     CacheManager *cacheManager_;
     std::string bundleName_;
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RESTORE_COORDINATOR_H
+#define RESTORE_COORDINATOR_H
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "task_scheduler.h"
+
+namespace OHOS::ObjectStore {
+enum SyncStatus {
+    SYNC_START,
+    SYNCING,
+    SYNC_SUCCESS,
+    SYNC_FAIL,
+};
+// pulls every session in parallel, a failed session is pulled again with backoff on the owned scheduler.
+// the notifier runs once: right after the last session finished, or when the timeout passes first
+class RestoreCoordinator : public std::enable_shared_from_this<RestoreCoordinator> {
+public:
+    using SyncDone = std::function<void(bool isSuccess)>;
+    // SUCCESS once the pull started, done runs when it ends. ERR_SINGLE_DEVICE counts as restored
+    using SyncFunc = std::function<uint32_t(const std::string &sessionId, const SyncDone &done)>;
+    // SUCCESS if every session was restored, ERR_TIMEOUT if the timeout passed first, otherwise ERR_SYNC_FAIL
+    using Notifier = std::function<void(uint32_t status)>;
+    static constexpr uint32_t MAX_RETRY_TIMES = 5;
+    static constexpr std::chrono::milliseconds INITIAL_BACKOFF = std::chrono::milliseconds(200);
+    static constexpr std::chrono::milliseconds MAX_BACKOFF = std::chrono::seconds(5);
+    // room for every retry of a session and a slow last pull
+    static constexpr std::chrono::milliseconds RESTORE_TIMEOUT = std::chrono::seconds(30);
+
+    RestoreCoordinator(const SyncFunc &sync, const Notifier &notifier,
+        std::chrono::milliseconds initialBackoff = INITIAL_BACKOFF,
+        std::chrono::milliseconds timeout = RESTORE_TIMEOUT);
+    void Start(const std::vector<std::string> &sessionIds);
+
+private:
+    void Sync(const std::string &sessionId, uint32_t attempt);
+    void Retry(const std::string &sessionId, uint32_t attempt);
+    void Finish(const std::string &sessionId, SyncStatus status);
+    // the sessions not finished yet fail, later answers and pending retries are ignored
+    void Expire();
+    SyncFunc sync_;
+    Notifier notifier_;
+    std::chrono::milliseconds initialBackoff_;
+    std::chrono::milliseconds timeout_;
+    std::mutex mutex_;
+    std::map<std::string, SyncStatus> syncStatus_;
+    size_t outstanding_ = 0;
+    bool hasFailed_ = false;
+    bool isExpired_ = false;
+    TaskScheduler::TaskId deadlineTask_ = TaskScheduler::INVALID_TASK_ID;
+    // last member, a pending retry holds the coordinator until it ran
+    TaskScheduler retryScheduler_;
+};
+} // namespace OHOS::ObjectStore
+
+#endif // RESTORE_COORDINATOR_H
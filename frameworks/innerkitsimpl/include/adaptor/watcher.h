@@ -29,6 +29,11 @@ public:
     virtual void OnChanged(const std::string &sessionid, const std::vector<std::string> &changedData) = 0;
 
     void OnChange(const DistributedDB::KvStoreChangedData &data) override;
+    // decides whether a field written by a peer replaces the local one, version is empty for peers without versions
+    virtual bool Accept(const std::string &key, const std::vector<uint8_t> &value, const std::vector<uint8_t> &version)
+    {
+        return true;
+    }
 
 private:
     std::string sessionId_;
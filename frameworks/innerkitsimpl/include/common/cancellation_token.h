@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace OHOS::ObjectStore {
+class CancellationToken {
+public:
+    using CallbackId = uint64_t;
+    static constexpr CallbackId INVALID_CALLBACK_ID = 0;
+
+    CancellationToken() {}
+    ~CancellationToken() {}
+
+    void Cancel()
+    {
+        std::map<CallbackId, std::function<void()>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (isCancelled_) {
+                return;
+            }
+            isCancelled_ = true;
+            callbacks.swap(callbacks_);
+        }
+        for (auto &callback : callbacks) {
+            callback.second();
+        }
+    }
+
+    bool IsCancelled()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return isCancelled_;
+    }
+
+    // runs at once if the token is already cancelled, INVALID_CALLBACK_ID is returned then
+    CallbackId OnCancel(const std::function<void()> &callback)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!isCancelled_) {
+                callbacks_.emplace(++lastId_, callback);
+                return lastId_;
+            }
+        }
+        callback();
+        return INVALID_CALLBACK_ID;
+    }
+
+    // for a long lived token, drops a callback no longer needed. a callback already running is not waited for
+    void RemoveCallback(CallbackId callbackId)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks_.erase(callbackId);
+    }
+
+private:
+    std::mutex mutex_;
+    bool isCancelled_ = false;
+    CallbackId lastId_ = INVALID_CALLBACK_ID;
+    std::map<CallbackId, std::function<void()>> callbacks_;
+};
+} // namespace OHOS::ObjectStore
+
+#endif // CANCELLATION_TOKEN_H
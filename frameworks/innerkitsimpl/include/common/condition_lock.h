@@ -16,6 +16,7 @@
 #ifndef CONDITION_LOCK_H
 #define CONDITION_LOCK_H
 
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 
@@ -43,6 +44,18 @@ public:
         return data;
     }
 
+    // false if nothing was notified before the timeout
+    bool WaitFor(std::chrono::milliseconds timeout, T &data)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this]() { return isSet_; })) {
+            return false;
+        }
+        data = data_;
+        cv_.notify_one();
+        return true;
+    }
+
     void Clear()
     {
         std::lock_guard<std::mutex> lock(mutex_);
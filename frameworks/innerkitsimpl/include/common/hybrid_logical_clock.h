@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRID_LOGICAL_CLOCK_H
+#define HYBRID_LOGICAL_CLOCK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "bytes.h"
+
+namespace OHOS::ObjectStore {
+struct FieldVersion {
+    uint64_t physical = 0;
+    uint32_t logical = 0;
+    uint32_t nodeId = 0;
+
+    bool operator<(const FieldVersion &other) const
+    {
+        if (physical != other.physical) {
+            return physical < other.physical;
+        }
+        if (logical != other.logical) {
+            return logical < other.logical;
+        }
+        return nodeId < other.nodeId;
+    }
+
+    bool operator==(const FieldVersion &other) const
+    {
+        return physical == other.physical && logical == other.logical && nodeId == other.nodeId;
+    }
+};
+
+class HybridLogicalClock {
+public:
+    HybridLogicalClock() {}
+    ~HybridLogicalClock() {}
+
+    // node id breaks ties between devices writing in the same millisecond, it must be equal on every peer
+    void SetNodeId(const std::string &deviceId)
+    {
+        constexpr uint32_t FNV_OFFSET = 2166136261u;
+        constexpr uint32_t FNV_PRIME = 16777619u;
+        uint32_t hash = FNV_OFFSET;
+        for (unsigned char c : deviceId) {
+            hash = (hash ^ c) * FNV_PRIME;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodeId_ = hash;
+    }
+
+    uint32_t GetNodeId()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return nodeId_;
+    }
+
+    // version for a local write
+    FieldVersion Tick()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t now = Now();
+        if (now > last_.physical) {
+            last_.physical = now;
+            last_.logical = 0;
+        } else {
+            last_.logical++;
+        }
+        return { last_.physical, last_.logical, nodeId_ };
+    }
+
+    // merge a version received from a peer, later local writes order after it
+    void Update(const FieldVersion &remote)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t physical = std::max({ Now(), last_.physical, remote.physical });
+        uint32_t logical = 0;
+        if (physical == last_.physical && physical == remote.physical) {
+            logical = std::max(last_.logical, remote.logical) + 1;
+        } else if (physical == last_.physical) {
+            logical = last_.logical + 1;
+        } else if (physical == remote.physical) {
+            logical = remote.logical + 1;
+        }
+        last_.physical = physical;
+        last_.logical = logical;
+    }
+
+private:
+    static uint64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::mutex mutex_;
+    FieldVersion last_;
+    uint32_t nodeId_ = 0;
+};
+
+// a field version is stored next to its field under VERSIONS_PREFIX + field key, the field value keeps its format
+// so peers without versions read it as before: [physical 8B][logical 4B][nodeId 4B], big endian
+class FieldVersionCodec final {
+public:
+    FieldVersionCodec() = delete;
+    ~FieldVersionCodec() = delete;
+    static constexpr uint32_t ENCODED_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+    static std::string GetVersionKey(const std::string &fieldKey)
+    {
+        return VERSIONS_PREFIX + fieldKey;
+    }
+
+    static bool IsVersionKey(const std::string &key)
+    {
+        return key.compare(0, VERSIONS_PREFIX_LEN, VERSIONS_PREFIX) == 0;
+    }
+
+    static Bytes Encode(const FieldVersion &version)
+    {
+        Bytes data;
+        AppendNum(data, version.physical, sizeof(version.physical));
+        AppendNum(data, version.logical, sizeof(version.logical));
+        AppendNum(data, version.nodeId, sizeof(version.nodeId));
+        return data;
+    }
+
+    static bool Decode(const Bytes &data, FieldVersion &version)
+    {
+        if (data.size() != ENCODED_SIZE) {
+            return false;
+        }
+        uint32_t offset = 0;
+        version.physical = ReadNum(data, offset, sizeof(version.physical));
+        offset += sizeof(version.physical);
+        version.logical = static_cast<uint32_t>(ReadNum(data, offset, sizeof(version.logical)));
+        offset += sizeof(version.logical);
+        version.nodeId = static_cast<uint32_t>(ReadNum(data, offset, sizeof(version.nodeId)));
+        return true;
+    }
+
+private:
+    static void AppendNum(Bytes &data, uint64_t value, uint32_t len)
+    {
+        for (uint32_t i = 0; i < len; i++) {
+            // 8 bit = 1 byte
+            data.push_back(static_cast<uint8_t>(value >> ((len - i - 1) * 8)));
+        }
+    }
+
+    static uint64_t ReadNum(const Bytes &data, uint32_t offset, uint32_t len)
+    {
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < len; i++) {
+            value = (value << 8) | data[offset + i];
+        }
+        return value;
+    }
+};
+
+// latest known version of every field of one object, only versions are kept, values stay in the store
+class FieldVersionTable {
+public:
+    void Put(const std::string &fieldKey, const FieldVersion &version)
+    {
+        versions_.insert_or_assign(fieldKey, version);
+    }
+
+    bool Get(const std::string &fieldKey, FieldVersion &version) const
+    {
+        auto iter = versions_.find(fieldKey);
+        if (iter == versions_.end()) {
+            return false;
+        }
+        version = iter->second;
+        return true;
+    }
+
+    void Remove(const std::string &fieldKey)
+    {
+        versions_.erase(fieldKey);
+    }
+
+    // last writer wins: true and the remote version is kept unless the known version is newer
+    bool Resolve(const std::string &fieldKey, const FieldVersion &remote)
+    {
+        auto iter = versions_.find(fieldKey);
+        if (iter != versions_.end() && remote < iter->second) {
+            return false;
+        }
+        versions_.insert_or_assign(fieldKey, remote);
+        return true;
+    }
+
+private:
+    std::map<std::string, FieldVersion> versions_;
+};
+} // namespace OHOS::ObjectStore
+
+#endif // HYBRID_LOGICAL_CLOCK_H
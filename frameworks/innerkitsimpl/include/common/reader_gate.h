@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef READER_GATE_H
+#define READER_GATE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace OHOS::ObjectStore {
+// grace period for snapshots read without a lock. readers hold a Reader while they use what they loaded, a writer
+// that replaced the snapshot calls Synchronize to wait until every reader that may still see the old one has left.
+// readers entering meanwhile count apart, so steady traffic does not hold the writer up, and a writer called back
+// from inside a read section of the same gate does not wait for itself.
+// entering and leaving take no lock, only a reader leaving while a writer waits wakes it under the mutex
+class ReaderGate {
+public:
+    class Reader {
+    public:
+        explicit Reader(ReaderGate &gate) : gate_(gate), outer_(GetInnermost())
+        {
+            while (true) {
+                uint64_t epoch = gate_.epoch_.load();
+                slot_ = epoch % SLOTS;
+                gate_.readers_[slot_]++;
+                if (gate_.epoch_.load() == epoch) {
+                    break;
+                }
+                // a writer switched slots meanwhile, count in the new one so that writer does not wait for us
+                gate_.Leave(slot_);
+            }
+            GetInnermost() = this;
+        }
+        ~Reader()
+        {
+            GetInnermost() = outer_;
+            gate_.Leave(slot_);
+        }
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+    private:
+        friend class ReaderGate;
+        ReaderGate &gate_;
+        // the read section of the calling thread this one is nested in, of any gate
+        Reader *outer_ = nullptr;
+        size_t slot_ = 0;
+    };
+
+    void Synchronize()
+    {
+        std::lock_guard<std::mutex> writer(writerMutex_);
+        size_t slot = epoch_++ % SLOTS;
+        size_t self = 0;
+        for (Reader *reader = GetInnermost(); reader != nullptr; reader = reader->outer_) {
+            self += (&reader->gate_ == this && reader->slot_ == slot) ? 1 : 0;
+        }
+        if (readers_[slot].load() <= self) {
+            return;
+        }
+        waiters_++;
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this, slot, self]() { return readers_[slot].load() <= self; });
+        waiters_--;
+    }
+
+private:
+    static constexpr size_t SLOTS = 2;
+    // the read section the calling thread is in, innermost first
+    static Reader *&GetInnermost()
+    {
+        static thread_local Reader *innermost = nullptr;
+        return innermost;
+    }
+
+    void Leave(size_t slot)
+    {
+        // the writer counts itself waiting before checking, so it sees this decrement or is woken by it.
+        // a writer inside a read section waits for its own sections to be the last, not for zero
+        readers_[slot]--;
+        if (waiters_.load() != 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cond_.notify_all();
+        }
+    }
+
+    // one writer at a time, so the slot a writer drains is not reused before it is empty
+    std::mutex writerMutex_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<uint64_t> epoch_{ 0 };
+    std::atomic<size_t> readers_[SLOTS] = { { 0 }, { 0 } };
+    std::atomic<uint32_t> waiters_{ 0 };
+};
+} // namespace OHOS::ObjectStore
+
+#endif // READER_GATE_H
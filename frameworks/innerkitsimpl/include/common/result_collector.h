@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RESULT_COLLECTOR_H
+#define RESULT_COLLECTOR_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace OHOS::ObjectStore {
+// gathers one result per key and hands all of them to callback once count distinct keys reported
+template<typename T>
+std::function<void(const std::string &key, T result)> CollectResults(
+    size_t count, const std::function<void(const std::map<std::string, T> &results)> &callback)
+{
+    auto mutex = std::make_shared<std::mutex>();
+    auto results = std::make_shared<std::map<std::string, T>>();
+    return [count, callback, mutex, results](const std::string &key, T result) {
+        std::map<std::string, T> collected;
+        {
+            std::lock_guard<std::mutex> lock(*mutex);
+            results->insert_or_assign(key, result);
+            if (results->size() < count) {
+                return;
+            }
+            collected.swap(*results);
+        }
+        callback(collected);
+    };
+}
+} // namespace OHOS::ObjectStore
+
+#endif // RESULT_COLLECTOR_H
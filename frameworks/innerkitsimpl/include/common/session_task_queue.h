@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SESSION_TASK_QUEUE_H
+#define SESSION_TASK_QUEUE_H
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "task_scheduler.h"
+
+namespace OHOS::ObjectStore {
+// tasks of one session run one after another, a task keeps its place until it calls done.
+// every task starts on the owned worker, never on the thread that finished the previous one (a binder thread)
+class SessionTaskQueue {
+public:
+    using Task = std::function<void(const std::function<void()> &done)>;
+
+    void Schedule(const std::string &sessionId, Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            SessionTasks &tasks = sessionTasks_[sessionId];
+            if (tasks.isRunning) {
+                tasks.pending.push_back(std::move(task));
+                return;
+            }
+            tasks.isRunning = true;
+        }
+        Start(sessionId, std::move(task));
+    }
+
+private:
+    struct SessionTasks {
+        bool isRunning = false;
+        std::deque<Task> pending;
+    };
+
+    void Start(const std::string &sessionId, Task task)
+    {
+        executor_.Execute([this, sessionId, task = std::move(task)]() {
+            task([this, sessionId]() { OnTaskDone(sessionId); });
+        });
+    }
+
+    void OnTaskDone(const std::string &sessionId)
+    {
+        Task next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto iter = sessionTasks_.find(sessionId);
+            if (iter == sessionTasks_.end()) {
+                return;
+            }
+            SessionTasks &tasks = iter->second;
+            if (tasks.pending.empty()) {
+                sessionTasks_.erase(iter);
+                return;
+            }
+            next = std::move(tasks.pending.front());
+            tasks.pending.pop_front();
+        }
+        Start(sessionId, std::move(next));
+    }
+
+    std::mutex mutex_;
+    std::map<std::string, SessionTasks> sessionTasks_;
+    // last member, joined before the queues its tasks use are destroyed
+    TaskScheduler executor_;
+};
+} // namespace OHOS::ObjectStore
+
+#endif // SESSION_TASK_QUEUE_H
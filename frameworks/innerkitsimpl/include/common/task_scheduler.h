@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace OHOS::ObjectStore {
+// one worker thread owned by its user, tasks run in time order and tasks due at the same time in posting order.
+// the thread starts with the first task, the destructor drops the tasks not started yet and joins it
+class TaskScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+    using TaskId = uint64_t;
+    static constexpr TaskId INVALID_TASK_ID = 0;
+
+    TaskScheduler() : state_(std::make_shared<State>())
+    {
+    }
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    ~TaskScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->isRunning = false;
+            state_->tasks.clear();
+            state_->cv.notify_one();
+        }
+        if (!thread_.joinable()) {
+            return;
+        }
+        // a task may drop the last reference of the owner, the thread keeps the state alive until it returns
+        if (thread_.get_id() == std::this_thread::get_id()) {
+            thread_.detach();
+            return;
+        }
+        thread_.join();
+    }
+
+    TaskId Execute(Task task)
+    {
+        return At(Clock::now(), std::move(task));
+    }
+
+    TaskId After(std::chrono::milliseconds delay, Task task)
+    {
+        return At(Clock::now() + delay, std::move(task));
+    }
+
+    TaskId At(Clock::time_point time, Task task)
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->isRunning || task == nullptr) {
+            return INVALID_TASK_ID;
+        }
+        TaskId taskId = ++state_->lastId;
+        state_->tasks.emplace(std::make_pair(time, taskId), std::move(task));
+        if (!thread_.joinable()) {
+            thread_ = std::thread([state = state_]() { Run(*state); });
+        }
+        state_->cv.notify_one();
+        return taskId;
+    }
+
+    // false if the task already started or was never posted
+    bool Remove(TaskId taskId)
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        for (auto iter = state_->tasks.begin(); iter != state_->tasks.end(); ++iter) {
+            if (iter->first.second == taskId) {
+                state_->tasks.erase(iter);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool isRunning = true;
+        TaskId lastId = INVALID_TASK_ID;
+        std::map<std::pair<Clock::time_point, TaskId>, Task> tasks;
+    };
+
+    static void Run(State &state)
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        while (state.isRunning) {
+            if (state.tasks.empty()) {
+                state.cv.wait(lock);
+                continue;
+            }
+            auto first = state.tasks.begin();
+            // a copy, the task may be removed while waiting
+            Clock::time_point time = first->first.first;
+            if (time > Clock::now()) {
+                state.cv.wait_until(lock, time);
+                continue;
+            }
+            Task task = std::move(first->second);
+            state.tasks.erase(first);
+            lock.unlock();
+            task();
+            // release what the task captured before waiting again
+            task = nullptr;
+            lock.lock();
+        }
+    }
+
+    std::shared_ptr<State> state_;
+    std::thread thread_;
+};
+} // namespace OHOS::ObjectStore
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WAIT_STATISTICS_H
+#define WAIT_STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "logger.h"
+
+namespace OHOS::ObjectStore {
+// wait time histogram and timeout counters of the service and softbus round trips
+class WaitStatistics {
+public:
+    enum Outcome {
+        COMPLETED,
+        TIMEOUT,
+        CANCELED,
+    };
+    // bucket i counts waits shorter than 2^i ms, the last one everything longer
+    static constexpr uint32_t BUCKET_SIZE = 17;
+    struct Statistic {
+        uint64_t completed = 0;
+        uint64_t timeout = 0;
+        uint64_t canceled = 0;
+        std::array<uint64_t, BUCKET_SIZE> histogram{};
+    };
+
+    static WaitStatistics &GetInstance()
+    {
+        static WaitStatistics instance;
+        return instance;
+    }
+
+    void Record(const std::string &name, std::chrono::milliseconds elapsed, Outcome outcome)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Statistic &statistic = statistics_[name];
+        uint32_t bucket = 0;
+        while (bucket < BUCKET_SIZE - 1 && elapsed.count() >= (1LL << bucket)) {
+            bucket++;
+        }
+        statistic.histogram[bucket]++;
+        switch (outcome) {
+            case TIMEOUT:
+                statistic.timeout++;
+                LOG_WARN("%{public}s timeout %{public}llu times, completed %{public}llu", name.c_str(),
+                    static_cast<unsigned long long>(statistic.timeout),
+                    static_cast<unsigned long long>(statistic.completed));
+                break;
+            case CANCELED:
+                statistic.canceled++;
+                break;
+            default:
+                statistic.completed++;
+                break;
+        }
+    }
+
+    Statistic Get(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = statistics_.find(name);
+        return iter == statistics_.end() ? Statistic() : iter->second;
+    }
+
+private:
+    WaitStatistics() {}
+    ~WaitStatistics() {}
+    std::mutex mutex_;
+    std::map<std::string, Statistic> statistics_;
+};
+} // namespace OHOS::ObjectStore
+
+#endif // WAIT_STATISTICS_H
@@ -32,6 +32,7 @@ public:
 
     DeviceInfo GetLocalDevice();
     std::vector<DeviceInfo> GetDeviceList() const;
+    uint32_t GetMtuSize(const std::string &deviceId) const;
 
     std::string GetUdidByNodeId(const std::string &nodeId) const;
     // get local device node information;
@@ -59,6 +59,9 @@ public:
     // Get local device information
     KVSTORE_API virtual DeviceInfo GetLocalDevice() const = 0;
 
+    // Get the max transmission unit of an online device, from cached device capabilities
+    KVSTORE_API virtual uint32_t GetMtuSize(const DeviceId &deviceId) const = 0;
+
     // start one server to listen data from other devices;
     KVSTORE_API virtual Status Start(const PipeInfo &pipeInfo) = 0;
 
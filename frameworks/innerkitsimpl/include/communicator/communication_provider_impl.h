@@ -52,6 +52,9 @@ public:
     // Get local device information
     DeviceInfo GetLocalDevice() const override;
 
+    // Get the max transmission unit of an online device
+    uint32_t GetMtuSize(const DeviceId &deviceId) const override;
+
     // start 1 server to listen data from other devices;
     Status Start(const PipeInfo &pipeInfo) override;
 
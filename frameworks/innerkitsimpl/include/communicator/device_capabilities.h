@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISTRIBUTEDDATAMGR_DEVICE_CAPABILITIES_H
+#define DISTRIBUTEDDATAMGR_DEVICE_CAPABILITIES_H
+
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace OHOS {
+namespace ObjectStore {
+struct DeviceCapability {
+    uint32_t deviceTypeId = 0;
+    uint32_t mtu = 0;
+    uint32_t fragmentSize = 0;
+};
+
+// what is known about each online device, keyed by udid. filled from device events, so asking costs no IPC
+class DeviceCapabilityTable {
+public:
+    static constexpr uint32_t DEFAULT_MTU = 4096 * 1024; // the max transmission unit size(4M - 80B)
+    // watches, cameras, speakers and other devices on a constrained link
+    static constexpr uint32_t LOW_CAPABILITY_MTU = 81920; // the max transmission unit size(80K)
+
+    void Put(const std::string &udid, const DeviceCapability &capability);
+    void Remove(const std::string &udid);
+    bool Get(const std::string &udid, DeviceCapability &capability) const;
+    std::vector<std::string> GetDevices() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, DeviceCapability> capabilities_;
+};
+} // namespace ObjectStore
+} // namespace OHOS
+#endif // DISTRIBUTEDDATAMGR_DEVICE_CAPABILITIES_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISTRIBUTEDDATAMGR_DEVICE_DIRECTORY_H
+#define DISTRIBUTEDDATAMGR_DEVICE_DIRECTORY_H
+
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace OHOS {
+namespace ObjectStore {
+// networkId <-> udid of the devices seen on the bus, both directions are hash lookups under a shared lock
+class DeviceDirectory {
+public:
+    void Put(const std::string &networkId, const std::string &udid)
+    {
+        if (networkId.empty() || udid.empty()) {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto old = udids_.find(networkId);
+        if (old != udids_.end() && old->second != udid) {
+            networkIds_.erase(old->second);
+        }
+        auto oldNetwork = networkIds_.find(udid);
+        if (oldNetwork != networkIds_.end() && oldNetwork->second != networkId) {
+            udids_.erase(oldNetwork->second);
+        }
+        udids_[networkId] = udid;
+        networkIds_[udid] = networkId;
+    }
+
+    bool Remove(const std::string &networkId)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto iter = udids_.find(networkId);
+        if (iter == udids_.end()) {
+            return false;
+        }
+        networkIds_.erase(iter->second);
+        udids_.erase(iter);
+        return true;
+    }
+
+    // empty if the device is unknown
+    std::string GetUdid(const std::string &networkId) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto iter = udids_.find(networkId);
+        return iter == udids_.end() ? "" : iter->second;
+    }
+
+    std::string GetNetworkId(const std::string &udid) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto iter = networkIds_.find(udid);
+        return iter == networkIds_.end() ? "" : iter->second;
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::string> udids_;
+    std::unordered_map<std::string, std::string> networkIds_;
+};
+} // namespace ObjectStore
+} // namespace OHOS
+#endif // DISTRIBUTEDDATAMGR_DEVICE_DIRECTORY_H
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISTRIBUTEDDATAMGR_DEVICE_EVENT_DISPATCHER_H
+#define DISTRIBUTEDDATAMGR_DEVICE_EVENT_DISPATCHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "app_types.h"
+
+namespace OHOS {
+namespace ObjectStore {
+// delivers device events on one thread, in the order they were posted. an event is held for the window and events of
+// the same device posted meanwhile are folded into it. a device coming and going within the window is dropped, one
+// going and coming back is delivered online as a reconnect, its sessions broke on the way
+class DeviceEventDispatcher {
+public:
+    using Handler = std::function<void(const DeviceInfo &info, DeviceChangeType type, bool isReconnect)>;
+    static constexpr std::chrono::milliseconds DEFAULT_WINDOW = std::chrono::milliseconds(500);
+
+    explicit DeviceEventDispatcher(const Handler &handler, std::chrono::milliseconds window = DEFAULT_WINDOW);
+    ~DeviceEventDispatcher();
+    // info.deviceId identifies the device
+    void Post(const DeviceInfo &info, DeviceChangeType type);
+
+private:
+    struct Pending {
+        DeviceInfo info;
+        DeviceChangeType first;
+        DeviceChangeType last;
+        bool isReconnect = false;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    void Run();
+    Handler handler_;
+    std::chrono::milliseconds window_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    // devices in the order of their first pending event, the deadlines are in the same order
+    std::deque<std::string> order_;
+    std::map<std::string, Pending> pending_;
+    bool isStopped_ = false;
+    std::thread thread_;
+};
+} // namespace ObjectStore
+} // namespace OHOS
+#endif // DISTRIBUTEDDATAMGR_DEVICE_EVENT_DISPATCHER_H
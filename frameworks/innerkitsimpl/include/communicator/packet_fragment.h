@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISTRIBUTEDDATAMGR_PACKET_FRAGMENT_H
+#define DISTRIBUTEDDATAMGR_PACKET_FRAGMENT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace OHOS {
+namespace ObjectStore {
+struct FragmentHeader {
+    uint32_t nonce = 0;
+    uint32_t msgId = 0;
+    uint32_t index = 0;
+    uint32_t count = 0;
+    uint32_t totalLength = 0;
+};
+
+// fragment layout: ['O' 'S' 'F' 'G'][nonce 4B][msgId 4B][index 4B][count 4B][total length 4B][payload], big endian.
+// the nonce is drawn once per sender process, so message ids counted again after a restart are not mistaken for
+// the packets the receiver still holds. packets up to the MTU of the device are sent as they are, and each fragment
+// with its header fits in one MTU
+class PacketFragment final {
+public:
+    PacketFragment() = delete;
+    ~PacketFragment() = delete;
+    static constexpr uint32_t MAGIC = 0x4F534647;
+    static constexpr uint32_t HEADER_SIZE = 6 * sizeof(uint32_t);
+    static constexpr uint32_t FRAGMENT_SIZE = 512 * 1024;
+    // payload of the fragments sent over a link of mtu bytes
+    static uint32_t GetFragmentSize(uint32_t mtu);
+    static uint32_t GetCount(uint32_t length, uint32_t fragmentSize);
+    // writes fragment index of data into buffer, the buffer is reused for every fragment of a packet
+    static void Encode(const uint8_t *data, uint32_t length, uint32_t fragmentSize, const FragmentHeader &header,
+        std::vector<uint8_t> &buffer);
+    static bool Decode(const uint8_t *data, uint32_t length, FragmentHeader &header);
+};
+
+// rebuilds packets from fragments received in order, per device and pipe. a packet outlives the session it started
+// on, so a sender can resume it on a reopened one. it is dropped on a gap, if no fragment arrives within the
+// timeout, if it does not fit in the pending bytes, or when its device goes offline
+class FragmentAssembler {
+public:
+    using Deliver = std::function<void(const uint8_t *data, uint32_t length)>;
+    // the most AppPipeMgr sends, room for two of them is kept so one stalled packet does not block the next
+    static constexpr uint32_t MAX_MESSAGE_SIZE = 16 * 1024 * 1024;
+    static constexpr size_t MAX_PENDING_BYTES = 2 * static_cast<size_t>(MAX_MESSAGE_SIZE);
+    static constexpr std::chrono::milliseconds REASSEMBLY_TIMEOUT = std::chrono::seconds(30);
+
+    explicit FragmentAssembler(
+        std::chrono::milliseconds timeout = REASSEMBLY_TIMEOUT, size_t maxPendingBytes = MAX_PENDING_BYTES);
+    // false if data is not a fragment, deliver runs once the last fragment of a packet arrived
+    bool Accept(const std::string &deviceId, const std::string &pipeId, const uint8_t *data, uint32_t length,
+        const Deliver &deliver);
+    // drops the packets of the device on every pipe
+    void Clear(const std::string &deviceId);
+    size_t GetPendingBytes();
+
+private:
+    struct Pending {
+        std::vector<uint8_t> data;
+        FragmentHeader header;
+        uint32_t nextIndex = 0;
+        std::chrono::steady_clock::time_point lastUpdate;
+    };
+    // device, pipe, nonce, message id
+    using Key = std::tuple<std::string, std::string, uint32_t, uint32_t>;
+    void DropExpired(std::chrono::steady_clock::time_point now);
+    void Drop(std::map<Key, Pending>::iterator iter);
+    std::chrono::milliseconds timeout_;
+    size_t maxPendingBytes_;
+    std::mutex mutex_;
+    std::map<Key, Pending> pending_;
+    size_t pendingBytes_ = 0;
+};
+
+// bounds the fragments handed to SoftBus and not yet acknowledged, per device across every packet sent to it, so
+// the buffers of a sender stay within window size fragments per device
+class FragmentWindow {
+public:
+    static constexpr uint32_t MAX_IN_FLIGHT = 4;
+
+    explicit FragmentWindow(uint32_t size = MAX_IN_FLIGHT);
+    // waits until the device has a free slot
+    void Acquire(const std::string &deviceId);
+    void Release(const std::string &deviceId);
+    uint32_t GetInFlight(const std::string &deviceId);
+
+private:
+    uint32_t size_;
+    std::mutex mutex_;
+    std::condition_variable released_;
+    // devices with nothing in flight are erased
+    std::map<std::string, uint32_t> inFlight_;
+};
+} // namespace ObjectStore
+} // namespace OHOS
+#endif // DISTRIBUTEDDATAMGR_PACKET_FRAGMENT_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISTRIBUTEDDATAMGR_PEER_SEND_QUEUE_H
+#define DISTRIBUTEDDATAMGR_PEER_SEND_QUEUE_H
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "task_scheduler.h"
+
+namespace OHOS {
+namespace ObjectStore {
+// one bounded queue per peer, drained in order by a worker of that peer, so a slow peer holds up its own packets
+// and nobody else's. a peer idle for idleTimeout or removed loses its queue and worker. the remaining workers live
+// as long as the queue, which its owner declares as its last member
+class PeerSendQueue {
+public:
+    using Sender = std::function<bool(const std::string &peer, const std::vector<uint8_t> &data)>;
+    enum PushStatus {
+        QUEUED,
+        // try again later, the packet is not queued
+        QUEUE_FULL,
+        // a packet queued before failed to send, the packets behind it were dropped and this one is not queued.
+        // reported once, the next push queues again
+        PEER_BROKEN,
+    };
+    static constexpr size_t MAX_QUEUE_SIZE = 32;
+    static constexpr size_t MAX_QUEUE_BYTES = 8 * 1024 * 1024;
+    static constexpr std::chrono::milliseconds IDLE_TIMEOUT = std::chrono::seconds(30);
+
+    explicit PeerSendQueue(const Sender &sender, size_t maxSize = MAX_QUEUE_SIZE, size_t maxBytes = MAX_QUEUE_BYTES,
+        std::chrono::milliseconds idleTimeout = IDLE_TIMEOUT);
+    ~PeerSendQueue();
+    // a packet bigger than maxBytes is still accepted by an empty queue
+    PushStatus Push(const std::string &peer, const uint8_t *data, uint32_t length);
+    // drops the packets not sent yet and the queue with its worker. the packet being sent still goes out, the
+    // worker goes once it is done
+    void Remove(const std::string &peer);
+    // packets of the peer waiting to be sent
+    size_t GetDepth(const std::string &peer);
+    // peers with a queue and a worker
+    size_t GetPeerCount();
+
+private:
+    struct PeerQueue {
+        std::deque<std::vector<uint8_t>> packets;
+        size_t bytes = 0;
+        bool isSending = false;
+        bool isBroken = false;
+        bool isRemoved = false;
+        // tells a queue from the one a peer had before it was removed
+        uint64_t generation = 0;
+        std::chrono::steady_clock::time_point lastActive;
+        std::unique_ptr<TaskScheduler> worker = std::make_unique<TaskScheduler>();
+    };
+    void Drain(const std::string &peer);
+    // mutex_ held, the worker of a removed queue is handed back to be destroyed outside it
+    std::unique_ptr<TaskScheduler> StopSending(std::map<std::string, PeerQueue>::iterator iter);
+    void RemoveIfIdle(const std::string &peer, uint64_t generation);
+    // mutex_ held, same as above
+    std::unique_ptr<TaskScheduler> Erase(std::map<std::string, PeerQueue>::iterator iter);
+    Sender sender_;
+    size_t maxSize_;
+    size_t maxBytes_;
+    std::chrono::milliseconds idleTimeout_;
+    std::mutex mutex_;
+    std::map<std::string, PeerQueue> queues_;
+    uint64_t lastGeneration_ = 0;
+};
+} // namespace ObjectStore
+} // namespace OHOS
+#endif // DISTRIBUTEDDATAMGR_PEER_SEND_QUEUE_H
@@ -16,10 +16,14 @@
 #ifndef PROCESS_COMMUNICATOR_IMPL_H
 #define PROCESS_COMMUNICATOR_IMPL_H
 
+#include <memory>
 #include <mutex>
 
 #include "communication_provider.h"
+#include "device_capabilities.h"
 #include "iprocess_communicator.h"
+#include "peer_send_queue.h"
+#include "reader_gate.h"
 
 namespace OHOS {
 namespace ObjectStore {
@@ -39,10 +43,16 @@ public:
     KVSTORE_API DBStatus Stop() override;
 
     KVSTORE_API DBStatus RegOnDeviceChange(const OnDeviceChange &callback) override;
+    // returns once the replaced callback is no longer running, unless called from inside it
     KVSTORE_API DBStatus RegOnDataReceive(const OnDataReceive &callback) override;
 
+    // queues the packet for the peer and returns at once. RATE_LIMIT while the queue of the peer is full,
+    // DB_ERROR once after a queued packet to the peer failed to send
     KVSTORE_API DBStatus SendData(const DeviceInfos &dstDevInfo, const uint8_t *data, uint32_t length) override;
+    // packets queued for the device and not sent yet
+    KVSTORE_API size_t GetSendQueueDepth(const std::string &deviceId);
     KVSTORE_API uint32_t GetMtuSize() override;
+    // answered from the cached device capabilities, no SoftBus call
     KVSTORE_API uint32_t GetMtuSize(const DeviceInfos &devInfo) override;
     KVSTORE_API DeviceInfos GetLocalDeviceInfos() override;
     KVSTORE_API std::vector<DeviceInfos> GetRemoteOnlineDeviceInfosList() override;
@@ -54,14 +64,14 @@ private:
 
     std::string thisProcessLabel_;
     OnDeviceChange onDeviceChangeHandler_;
-    OnDataReceive onDataReceiveHandler_;
+    // read with atomic_load on every packet, replaced whole by RegOnDataReceive
+    std::shared_ptr<const OnDataReceive> onDataReceiveHandler_;
+    // entered by every OnMessage, RegOnDataReceive waits there for the calls to the replaced handler
+    mutable ReaderGate handlerGate_;
     mutable std::mutex onDeviceChangeMutex_;
-    mutable std::mutex onDataReceiveMutex_;
-
-    static constexpr uint32_t MTU_SIZE = 4096 * 1024;        // the max transmission unit size(4M - 80B)
-    static constexpr uint32_t MTU_SIZE_WATCH = 81920; // the max transmission unit size(80K)
-    static constexpr const char *SMART_WATCH_TYPE = "SMART_WATCH";
-    static constexpr const char *CHILDREN_WATCH_TYPE = "CHILDREN_WATCH";
+    // last member, its workers send with the label above and are joined first. the queue of a device going
+    // offline is removed from OnDeviceChanged
+    mutable PeerSendQueue sendQueue_;
 };
 } // namespace ObjectStore
 } // namespace OHOS
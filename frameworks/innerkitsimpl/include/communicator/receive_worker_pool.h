@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISTRIBUTEDDATAMGR_RECEIVE_WORKER_POOL_H
+#define DISTRIBUTEDDATAMGR_RECEIVE_WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace OHOS {
+namespace ObjectStore {
+// takes received packets off the SoftBus callback threads. a peer always lands on the same worker, so its packets
+// are handled in the order they came, while peers on different workers are handled in parallel
+class ReceiveWorkerPool {
+public:
+    using Task = std::function<void()>;
+    static constexpr size_t DEFAULT_WORKERS = 4;
+    static constexpr size_t MAX_PEER_BYTES = 16 * 1024 * 1024;
+
+    explicit ReceiveWorkerPool(size_t workers = DEFAULT_WORKERS, size_t maxPeerBytes = MAX_PEER_BYTES);
+    // tasks not started yet are dropped
+    ~ReceiveWorkerPool();
+    // bytes is what the task holds, until it is done. never waits: a task that would take the peer over
+    // maxPeerBytes is dropped and counted, so a stalled handler costs that peer its packets instead of holding up
+    // the SoftBus thread for every peer. a peer holding nothing takes any task, and a task of no bytes is always
+    // taken. false if the task was dropped
+    bool Post(const std::string &peer, size_t bytes, Task task);
+    size_t GetWorkerCount() const;
+    // tasks of the peer dropped so far
+    uint64_t GetDropped(const std::string &peer);
+
+private:
+    struct Item {
+        std::string peer;
+        size_t bytes = 0;
+        Task task;
+    };
+    struct Peer {
+        size_t bytes = 0;
+        uint64_t dropped = 0;
+    };
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<Item> tasks;
+        // peers holding bytes or with dropped tasks, erased once neither
+        std::map<std::string, Peer> peers;
+        bool isStopped = false;
+        std::thread thread;
+    };
+    Worker &GetWorker(const std::string &peer);
+    static void Run(Worker &worker);
+    size_t maxPeerBytes_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+} // namespace ObjectStore
+} // namespace OHOS
+#endif // DISTRIBUTEDDATAMGR_RECEIVE_WORKER_POOL_H
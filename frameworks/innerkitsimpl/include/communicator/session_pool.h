@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DISTRIBUTEDDATAMGR_SESSION_POOL_H
+#define DISTRIBUTEDDATAMGR_SESSION_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "task_scheduler.h"
+
+namespace OHOS {
+namespace ObjectStore {
+// opened sessions kept per (pipe, peer) and reused by later sends, SoftBus is reached only through opener and closer
+class SessionPool {
+public:
+    // returns the opened session id, negative if the session could not be opened.
+    // token is cancelled by Clear, the opener stops waiting for the session then
+    using Opener = std::function<int32_t(
+        const std::string &pipeId, const std::string &peer, const std::shared_ptr<CancellationToken> &token)>;
+    using Closer = std::function<void(int32_t sessionId)>;
+    static constexpr int32_t INVALID_SESSION = -1;
+    static constexpr std::chrono::milliseconds IDLE_TIMEOUT = std::chrono::seconds(30);
+    static constexpr std::chrono::milliseconds ACQUIRE_TIMEOUT = std::chrono::seconds(10);
+    static constexpr uint32_t MAX_OPENING = 4;
+    static constexpr uint32_t MAX_FAILURES = 2;
+
+    SessionPool(const Opener &opener, const Closer &closer, std::chrono::milliseconds idleTimeout = IDLE_TIMEOUT,
+        uint32_t maxOpening = MAX_OPENING);
+    // cancels the idle check and closes the pooled sessions
+    ~SessionPool();
+    // a pooled session, or a new one once fewer than maxOpening sessions are being opened
+    int32_t Acquire(const std::string &pipeId, const std::string &peer);
+    // a session failing MAX_FAILURES sends in a row is closed, the next acquire opens a new one
+    void Release(const std::string &pipeId, const std::string &peer, int32_t sessionId, bool isSuccess);
+    // the session was closed by SoftBus or the peer, forget it without closing it again
+    void OnClosed(int32_t sessionId);
+    void CloseIdle();
+    // closes the pooled sessions and cancels the opens in progress
+    void Clear();
+    size_t Size();
+
+private:
+    struct Entry {
+        int32_t sessionId = INVALID_SESSION;
+        bool isOpening = false;
+        uint32_t failures = 0;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+    static std::string GetKey(const std::string &pipeId, const std::string &peer);
+    // mutex_ held, checks for idle sessions every half idle timeout while sessions are pooled
+    void ScheduleReap();
+    void Reap();
+    void CloseAll(const std::vector<int32_t> &sessionIds);
+    Opener opener_;
+    Closer closer_;
+    std::chrono::milliseconds idleTimeout_;
+    uint32_t maxOpening_;
+    std::mutex mutex_;
+    std::condition_variable openDone_;
+    std::map<std::string, Entry> entries_;
+    uint32_t opening_ = 0;
+    // handed to the opens in progress, replaced by Clear after cancelling it
+    std::shared_ptr<CancellationToken> openToken_ = std::make_shared<CancellationToken>();
+    TaskScheduler::TaskId reapTask_ = TaskScheduler::INVALID_TASK_ID;
+    // last member, joined before the entries the idle check reads are gone
+    TaskScheduler reaper_;
+};
+} // namespace ObjectStore
+} // namespace OHOS
+#endif // DISTRIBUTEDDATAMGR_SESSION_POOL_H
@@ -15,9 +15,12 @@
 
 #ifndef DISTRIBUTEDDATAFWK_SRC_SOFTBUS_ADAPTER_H
 #define DISTRIBUTEDDATAFWK_SRC_SOFTBUS_ADAPTER_H
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <set>
+#include <shared_mutex>
 #include <tuple>
 
 #include "app_data_change_listener.h"
@@ -25,12 +28,29 @@
 #include "app_types.h"
 #include "session.h"
 #include "softbus_bus_center.h"
+#include "cancellation_token.h"
 #include "condition_lock.h"
+#include "device_capabilities.h"
+#include "device_directory.h"
+#include "device_event_dispatcher.h"
+#include "packet_fragment.h"
+#include "reader_gate.h"
+#include "receive_worker_pool.h"
+#include "session_pool.h"
 
 namespace OHOS {
 namespace ObjectStore {
+// what SoftBus tells about the other end of a session, it does not change while the session is open
+struct SessionPeer {
+    std::string mySessionName;
+    std::string peerSessionName;
+    std::string udid;
+};
+
 class SoftBusAdapter {
 public:
+    static constexpr std::chrono::milliseconds SESSION_OPEN_TIMEOUT = std::chrono::seconds(5);
+    static constexpr std::chrono::milliseconds DEVICE_EVENT_WINDOW = DeviceEventDispatcher::DEFAULT_WINDOW;
     SoftBusAdapter();
     ~SoftBusAdapter();
     static std::shared_ptr<SoftBusAdapter> GetInstance();
@@ -40,9 +60,14 @@ public:
     Status StartWatchDeviceChange(const AppDeviceStatusChangeListener *observer, const PipeInfo &pipeInfo);
     // stop DeviceChangeListener to watch device change;
     Status StopWatchDeviceChange(const AppDeviceStatusChangeListener *observer, const PipeInfo &pipeInfo);
+    // listeners are told on the dispatcher thread, after flaps within DEVICE_EVENT_WINDOW are folded
     void NotifyAll(const DeviceInfo &deviceInfo, const DeviceChangeType &type);
     DeviceInfo GetLocalDevice();
     std::vector<DeviceInfo> GetDeviceList() const;
+    // udids of the online devices, from the capability table rather than SoftBus while the table knows any
+    std::vector<std::string> GetOnlineDevices() const;
+    uint32_t GetMtuSize(const std::string &deviceId) const;
+    // answered from the device directory, softbus is only asked for devices not seen online yet
     std::string GetUdidByNodeId(const std::string &nodeId) const;
     // get local device node information;
     DeviceInfo GetLocalBasicInfo() const;
@@ -53,10 +78,13 @@ public:
     // add DataChangeListener to watch data change;
     Status StartWatchDataChange(const AppDataChangeListener *observer, const PipeInfo &pipeInfo);
 
-    // stop DataChangeListener to watch data change;
+    // stop DataChangeListener to watch data change, returns once no message is being delivered to it
+    // unless called from inside such a delivery;
     Status StopWatchDataChange(const AppDataChangeListener *observer, const PipeInfo &pipeInfo);
 
     // Send data to other device, function will be called back after sent to notify send result.
+    // packets above the MTU of the device are streamed fragment by fragment, a packet failing halfway resumes
+    // from the fragment that failed
     Status SendData(
         const PipeInfo &pipeInfo, const DeviceId &deviceId, const uint8_t *ptr, int size, const MessageInfo &info);
 
@@ -76,24 +104,58 @@ public:
 
     void NotifyDataListeners(const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo);
 
+    // the packet is copied and handled on the receive worker of the device, fragments are reassembled there and
+    // listeners only see whole packets. it is dropped, not waited for, while the device holds too many bytes there
+    void OnBytesReceived(const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo);
+
+    // handled on the receive worker of the device, after the packets received from it before
+    void OnMessageReceived(const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo);
+
     std::string ToNodeID(const std::string &nodeId) const;
 
-    int32_t GetSessionStatus(int32_t sessionId);
+    // SOFTBUS_ERR if the session is not opened within timeout or the token is cancelled first
+    int32_t GetSessionStatus(int32_t sessionId, std::chrono::milliseconds timeout = SESSION_OPEN_TIMEOUT,
+        const std::shared_ptr<CancellationToken> &token = nullptr);
 
     void OnSessionOpen(int32_t sessionId, int32_t status);
 
     void OnSessionClose(int32_t sessionId);
 
+    // asks SoftBus once the session opened and caches the answer until it closes. false if SoftBus does not know
+    // the session or its device, or if the session closed meanwhile; nothing is cached then
+    bool OpenSessionPeer(int32_t sessionId, SessionPeer &peer);
+
+    // from the cache, SoftBus is asked without caching for a session not opened through OpenSessionPeer
+    bool GetSessionPeer(int32_t sessionId, SessionPeer &peer);
+
 private:
     std::shared_ptr<ConditionLock<int32_t>> GetSemaphore (int32_t sessinId);
-    mutable std::mutex networkMutex_{};
-    mutable std::map<std::string, std::string> networkId2Udid_{};
+    int32_t OpenSessionSync(
+        const std::string &pipeId, const std::string &networkId, const std::shared_ptr<CancellationToken> &token);
+    void ClearSessionStatus(int32_t sessionId);
+    void ClearSessionPeer(int32_t sessionId);
+    bool QuerySessionPeer(int32_t sessionId, SessionPeer &peer);
+    void DispatchDeviceChange(const DeviceInfo &deviceInfo, DeviceChangeType type, bool isReconnect);
+    void HandleBytes(const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo);
+    std::string QueryUdid(const std::string &nodeId) const;
+    void LoadDirectory() const;
+    Status SendBytesOnce(const PipeInfo &pipeInfo, const std::string &networkId, const uint8_t *ptr, int size);
+    Status SendFragments(const PipeInfo &pipeInfo, const std::string &networkId, const uint8_t *ptr, int size,
+        uint32_t fragmentSize);
+    static DeviceCapability MakeCapability(uint32_t deviceTypeId);
+    static constexpr uint32_t MAX_RESEND_TIMES = 3;
+    mutable DeviceDirectory directory_;
+    mutable DeviceCapabilityTable capabilities_;
     DeviceInfo localInfo_{};
     static std::shared_ptr<SoftBusAdapter> instance_;
     std::mutex deviceChangeMutex_;
     std::set<const AppDeviceStatusChangeListener *> listeners_{};
+    using DataListeners = std::map<std::string, const AppDataChangeListener *>;
+    // serializes writers only, readers take a snapshot of dataChangeListeners_ with atomic_load
     std::mutex dataChangeMutex_{};
-    std::map<std::string, const AppDataChangeListener *> dataChangeListeners_{};
+    std::shared_ptr<const DataListeners> dataChangeListeners_ = std::make_shared<const DataListeners>();
+    // entered by every delivery, so a stopped listener is not called once StopWatchDataChange returned
+    ReaderGate listenerGate_;
     std::mutex busSessionMutex_{};
     std::map<std::string, bool> busSessionMap_{};
     bool flag_ = true; // only for br flag
@@ -101,6 +163,20 @@ private:
     ISessionListener sessionListener_{};
     std::mutex statusMutex_ {};
     std::map<int32_t, std::shared_ptr<ConditionLock<int32_t>>> sessionsStatus_;
+    std::shared_ptr<SessionPool> sessionPool_;
+    std::shared_mutex peerMutex_;
+    std::map<int32_t, SessionPeer> sessionPeers_;
+    // sessions whose peer OpenSessionPeer is asking SoftBus for, a close erases them so the answer is dropped
+    std::set<int32_t> openingPeers_;
+    // drawn once per process, tells a restarted sender apart from the packets a receiver still holds of it
+    const uint32_t msgNonce_;
+    std::atomic<uint32_t> nextMsgId_{ 0 };
+    FragmentWindow fragmentWindow_;
+    FragmentAssembler assembler_;
+    // after assembler_ and the listener tables, its workers are joined before those are gone
+    std::unique_ptr<ReceiveWorkerPool> receivePool_;
+    // last member, its thread is joined before the listeners it calls are gone
+    std::unique_ptr<DeviceEventDispatcher> deviceEvents_;
 };
 } // namespace ObjectStore
 } // namespace OHOS
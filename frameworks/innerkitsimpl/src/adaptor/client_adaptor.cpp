@@ -15,51 +15,208 @@
 
 #include "client_adaptor.h"
 
+#include <algorithm>
 #include <thread>
 
 #include "logger.h"
 #include "iservice_registry.h"
+#include "wait_statistics.h"
 
 namespace OHOS::ObjectStore {
-sptr<OHOS::DistributedObject::IObjectService> ClientAdaptor::GetObjectService()
+std::mutex ClientAdaptor::mutex_;
+sptr<OHOS::DistributedObject::IObjectService> ClientAdaptor::objectService_ = nullptr;
+uint64_t ClientAdaptor::generation_ = 0;
+std::mutex ClientAdaptor::discoveryMutex_;
+bool ClientAdaptor::isDiscovering_ = false;
+bool ClientAdaptor::isReady_ = false;
+std::shared_ptr<std::promise<ClientAdaptor::DataManager>> ClientAdaptor::readyPromise_ = nullptr;
+std::shared_future<ClientAdaptor::DataManager> ClientAdaptor::readyFuture_;
+ClientAdaptor::DataManager ClientAdaptor::distributedDataMgr_ = nullptr;
+sptr<IRemoteObject::DeathRecipient> ClientAdaptor::deathRecipient_ = nullptr;
+std::once_flag ClientAdaptor::subscribeFlag_;
+sptr<ISystemAbilityStatusChange> ClientAdaptor::statusListener_ = nullptr;
+
+void ClientAdaptor::Prefetch()
 {
-    static sptr<OHOS::DistributedKv::IKvStoreDataService> distributedDataMgr;
-    if (distributedDataMgr == nullptr) {
-        distributedDataMgr = GetDistributedDataManager();
+    GetReadyFuture();
+}
+
+sptr<OHOS::DistributedObject::IObjectService> ClientAdaptor::GetObjectService(std::chrono::milliseconds timeout)
+{
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // the death notification may still be on its way, a dead proxy is never handed out again
+        if (objectService_ != nullptr && !IsDead(objectService_->AsObject())) {
+            return objectService_;
+        }
+        objectService_ = nullptr;
+        generation = generation_;
     }
-    if (distributedDataMgr == nullptr) {
+    auto start = std::chrono::steady_clock::now();
+    std::shared_future<DataManager> future = GetReadyFuture();
+    bool isReady = future.wait_for(timeout) == std::future_status::ready;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    WaitStatistics::GetInstance().Record(
+        "service discovery", elapsed, isReady ? WaitStatistics::COMPLETED : WaitStatistics::TIMEOUT);
+    if (!isReady) {
         LOG_ERROR("get distributed data manager failed");
         return nullptr;
     }
-
+    DataManager distributedDataMgr = future.get();
+    // the lookup is an IPC, it runs without the lock and concurrent callers may both do it
     auto remote = distributedDataMgr->GetObjectService();
-    if (remote == nullptr) {
+    if (remote == nullptr || IsDead(remote)) {
         LOG_ERROR("get object service failed");
         return nullptr;
     }
-    return iface_cast<DistributedObject::IObjectService>(remote);
+    sptr<OHOS::DistributedObject::IObjectService> objectService =
+        iface_cast<DistributedObject::IObjectService>(remote);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (objectService_ != nullptr) {
+        return objectService_;
+    }
+    if (generation != generation_) {
+        LOG_WARN("distributed data service died during the lookup");
+        return nullptr;
+    }
+    objectService_ = objectService;
+    return objectService_;
+}
+
+bool ClientAdaptor::IsDead(const sptr<IRemoteObject> &remote)
+{
+    return remote == nullptr || remote->IsObjectDead();
+}
+
+std::shared_future<ClientAdaptor::DataManager> ClientAdaptor::GetReadyFuture()
+{
+    std::lock_guard<std::mutex> lock(discoveryMutex_);
+    if (readyPromise_ == nullptr) {
+        readyPromise_ = std::make_shared<std::promise<DataManager>>();
+        readyFuture_ = readyPromise_->get_future().share();
+    }
+    if (!isReady_ && !isDiscovering_) {
+        isDiscovering_ = true;
+        std::thread th = std::thread([]() { Discover(); });
+        th.detach();
+    }
+    return readyFuture_;
 }
 
-sptr<DistributedKv::IKvStoreDataService> ClientAdaptor::GetDistributedDataManager()
+void ClientAdaptor::Discover()
 {
-    int retry = 0;
-    while (++retry <= GET_SA_RETRY_TIMES) {
-        auto manager = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
-        if (manager == nullptr) {
-            LOG_ERROR("get system ability manager failed");
-            return nullptr;
+    auto manager = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
+    if (manager == nullptr) {
+        LOG_ERROR("get system ability manager failed");
+        std::lock_guard<std::mutex> lock(discoveryMutex_);
+        isDiscovering_ = false;
+        return;
+    }
+    std::call_once(subscribeFlag_, [&manager]() {
+        sptr<ISystemAbilityStatusChange> listener = new (std::nothrow) ServiceStatusListener();
+        if (listener == nullptr
+            || manager->SubscribeSystemAbility(DISTRIBUTED_KV_DATA_SERVICE_ABILITY_ID, listener) != ERR_OK) {
+            LOG_WARN("subscribe distributed data manager failed");
+            return;
+        }
+        statusListener_ = listener;
+    });
+    // the listener covers a service started later, checking covers one that is already running
+    auto interval = MIN_CHECK_INTERVAL;
+    for (int32_t i = 0; i < MAX_CHECK_TIMES; i++) {
+        {
+            std::lock_guard<std::mutex> lock(discoveryMutex_);
+            if (isReady_) {
+                return;
+            }
         }
-        LOG_INFO("get distributed data manager %{public}d", retry);
+        LOG_INFO("get distributed data manager %{public}d", i);
         auto remoteObject = manager->CheckSystemAbility(DISTRIBUTED_KV_DATA_SERVICE_ABILITY_ID);
-        if (remoteObject == nullptr) {
-            std::this_thread::sleep_for(std::chrono::seconds(RETRY_INTERVAL));
-            continue;
+        if (remoteObject != nullptr) {
+            OnServiceReady(remoteObject);
+            return;
+        }
+        std::this_thread::sleep_for(interval);
+        interval = std::min(interval * 2, MAX_CHECK_INTERVAL);
+    }
+    LOG_WARN("distributed data manager not started yet");
+    std::lock_guard<std::mutex> lock(discoveryMutex_);
+    isDiscovering_ = false;
+}
+
+void ClientAdaptor::OnServiceReady(const sptr<IRemoteObject> &remote)
+{
+    DataManager distributedDataMgr = iface_cast<DistributedKv::IKvStoreDataService>(remote);
+    if (distributedDataMgr == nullptr) {
+        LOG_ERROR("get distributed data manager failed");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(discoveryMutex_);
+    if (isReady_) {
+        return;
+    }
+    if (deathRecipient_ == nullptr) {
+        deathRecipient_ = new (std::nothrow) ServiceDeathRecipient();
+    }
+    if (deathRecipient_ == nullptr || !remote->AddDeathRecipient(deathRecipient_)) {
+        LOG_WARN("add death recipient failed, the cached proxy will not be refreshed");
+    }
+    if (readyPromise_ == nullptr) {
+        readyPromise_ = std::make_shared<std::promise<DataManager>>();
+        readyFuture_ = readyPromise_->get_future().share();
+    }
+    distributedDataMgr_ = distributedDataMgr;
+    isReady_ = true;
+    isDiscovering_ = false;
+    readyPromise_->set_value(distributedDataMgr);
+    LOG_INFO("get distributed data manager success");
+}
+
+void ClientAdaptor::ResetObjectService(const wptr<IRemoteObject> &remote)
+{
+    {
+        std::lock_guard<std::mutex> lock(discoveryMutex_);
+        if (distributedDataMgr_ == nullptr || distributedDataMgr_->AsObject() != remote.promote()) {
+            return;
         }
-        LOG_INFO("get distributed data manager success");
-        return iface_cast<DistributedKv::IKvStoreDataService>(remoteObject);
+        distributedDataMgr_->AsObject()->RemoveDeathRecipient(deathRecipient_);
+        distributedDataMgr_ = nullptr;
+        isReady_ = false;
+        readyPromise_ = std::make_shared<std::promise<DataManager>>();
+        readyFuture_ = readyPromise_->get_future().share();
     }
+    std::lock_guard<std::mutex> lock(mutex_);
+    objectService_ = nullptr;
+    generation_++;
+}
+
+void ClientAdaptor::ServiceDeathRecipient::OnRemoteDied(const wptr<IRemoteObject> &remote)
+{
+    LOG_WARN("distributed data service died, reconnect");
+    ResetObjectService(remote);
+    Prefetch();
+}
+
+void ClientAdaptor::ServiceStatusListener::OnAddSystemAbility(int32_t systemAbilityId, const std::string &deviceId)
+{
+    if (systemAbilityId != DISTRIBUTED_KV_DATA_SERVICE_ABILITY_ID) {
+        return;
+    }
+    auto manager = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
+    if (manager == nullptr) {
+        LOG_ERROR("get system ability manager failed");
+        return;
+    }
+    auto remoteObject = manager->CheckSystemAbility(DISTRIBUTED_KV_DATA_SERVICE_ABILITY_ID);
+    if (remoteObject != nullptr) {
+        OnServiceReady(remoteObject);
+    }
+}
 
-    LOG_ERROR("get distributed data manager failed");
-    return nullptr;
+void ClientAdaptor::ServiceStatusListener::OnRemoveSystemAbility(
+    int32_t systemAbilityId, const std::string &deviceId)
+{
+    LOG_WARN("system ability %{public}d removed", systemAbilityId);
+}
 }
-}
\ No newline at end of file
@@ -208,6 +208,17 @@ uint32_t DistributedObjectImpl::Save(const std::string &deviceId)
     return status;
 }
 
+uint32_t DistributedObjectImpl::Save(const std::vector<std::string> &deviceIds, std::map<std::string, int32_t> &results)
+{
+    uint32_t status = flatObjectStore_->Save(sessionId_, deviceIds, results);
+    if (status != SUCCESS) {
+        LOG_ERROR("DistributedObjectImpl:Save to %{public}zu devices failed. status = %{public}d", deviceIds.size(),
+            status);
+        return status;
+    }
+    return status;
+}
+
 uint32_t DistributedObjectImpl::RevokeSave()
 {
     uint32_t status = flatObjectStore_->RevokeSave(sessionId_);
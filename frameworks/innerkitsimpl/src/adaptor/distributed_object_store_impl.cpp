@@ -15,6 +15,7 @@
 
 #include <thread>
 
+#include "client_adaptor.h"
 #include "dds_trace.h"
 #include "distributed_object_impl.h"
 #include "distributed_objectstore_impl.h"
@@ -41,22 +42,31 @@ DistributedObject *DistributedObjectStoreImpl::CacheObject(
         return nullptr;
     }
     std::unique_lock<std::shared_mutex> cacheLock(dataMutex_);
-    objects_.push_back(object);
+    objects_[sessionId].push_back(object);
     return object;
 }
 
 void DistributedObjectStoreImpl::RemoveCacheObject(const std::string &sessionId)
 {
-    std::unique_lock<std::shared_mutex> cacheLock(dataMutex_);
-    auto iter = objects_.begin();
-    while (iter != objects_.end()) {
-        if ((*iter)->GetSessionId() == sessionId) {
-            delete *iter;
-            iter = objects_.erase(iter);
-        } else {
-            iter++;
+    std::vector<DistributedObject *> objects;
+    {
+        std::unique_lock<std::shared_mutex> cacheLock(dataMutex_);
+        auto iter = objects_.find(sessionId);
+        if (iter == objects_.end()) {
+            return;
+        }
+        objects.swap(iter->second);
+        objects_.erase(iter);
+    }
+    {
+        std::lock_guard<std::mutex> lock(watcherMutex_);
+        for (auto object : objects) {
+            watchers_.erase(object);
         }
     }
+    for (auto object : objects) {
+        delete object;
+    }
     return;
 }
 
@@ -95,13 +105,11 @@ uint32_t DistributedObjectStoreImpl::DeleteObject(const std::string &sessionId)
 
 uint32_t DistributedObjectStoreImpl::Get(const std::string &sessionId, DistributedObject **object)
 {
-    auto iter = objects_.begin();
-    while (iter != objects_.end()) {
-        if ((*iter)->GetSessionId() == sessionId) {
-            *object = *iter;
-            return SUCCESS;
-        }
-        iter++;
+    std::shared_lock<std::shared_mutex> cacheLock(dataMutex_);
+    auto iter = objects_.find(sessionId);
+    if (iter != objects_.end() && !iter->second.empty()) {
+        *object = iter->second.front();
+        return SUCCESS;
     }
     LOG_ERROR("DistributedObjectStoreImpl::Get object err, no object");
     return ERR_GET_OBJECT;
@@ -117,7 +125,9 @@ uint32_t DistributedObjectStoreImpl::Watch(DistributedObject *object, std::share
         LOG_ERROR("DistributedObjectStoreImpl::Sync object err ");
         return ERR_NULL_OBJECTSTORE;
     }
-    if (watchers_.count(object) != 0) {
+    std::lock_guard<std::mutex> lock(watcherMutex_);
+    auto &objectWatchers = watchers_[object];
+    if (objectWatchers.count(watcher.get()) != 0) {
         LOG_ERROR("DistributedObjectStoreImpl::Watch already gets object");
         return ERR_EXIST;
     }
@@ -125,9 +135,12 @@ uint32_t DistributedObjectStoreImpl::Watch(DistributedObject *object, std::share
     uint32_t status = flatObjectStore_->Watch(object->GetSessionId(), watcherProxy);
     if (status != SUCCESS) {
         LOG_ERROR("DistributedObjectStoreImpl::Watch failed %{public}d", status);
+        if (objectWatchers.empty()) {
+            watchers_.erase(object);
+        }
         return status;
     }
-    watchers_.insert_or_assign(object, watcherProxy);
+    objectWatchers.insert_or_assign(watcher.get(), watcherProxy);
     LOG_INFO("DistributedObjectStoreImpl:Watch object success.");
     return SUCCESS;
 }
@@ -142,83 +155,133 @@ uint32_t DistributedObjectStoreImpl::UnWatch(DistributedObject *object)
         LOG_ERROR("DistributedObjectStoreImpl::Sync object err ");
         return ERR_NULL_OBJECTSTORE;
     }
-    uint32_t status = flatObjectStore_->UnWatch(object->GetSessionId());
+    std::lock_guard<std::mutex> lock(watcherMutex_);
+    auto iter = watchers_.find(object);
+    if (iter == watchers_.end()) {
+        LOG_ERROR("DistributedObjectStoreImpl::UnWatch no watcher");
+        return ERR_NO_OBSERVER;
+    }
+    // every watcher is tried, the failed ones stay registered for a later UnWatch
+    uint32_t result = SUCCESS;
+    for (auto item = iter->second.begin(); item != iter->second.end();) {
+        uint32_t status = flatObjectStore_->UnWatch(object->GetSessionId(), item->second);
+        if (status != SUCCESS) {
+            LOG_ERROR("DistributedObjectStoreImpl::UnWatch failed %{public}d", status);
+            result = result == SUCCESS ? status : result;
+            ++item;
+            continue;
+        }
+        item = iter->second.erase(item);
+    }
+    if (iter->second.empty()) {
+        watchers_.erase(iter);
+    }
+    if (result != SUCCESS) {
+        return result;
+    }
+    LOG_INFO("DistributedObjectStoreImpl:UnWatch object success.");
+    return SUCCESS;
+}
+
+uint32_t DistributedObjectStoreImpl::UnWatch(DistributedObject *object, std::shared_ptr<ObjectWatcher> watcher)
+{
+    if (object == nullptr) {
+        LOG_ERROR("DistributedObjectStoreImpl::UnWatch object err ");
+        return ERR_NULL_OBJECT;
+    }
+    if (flatObjectStore_ == nullptr) {
+        LOG_ERROR("DistributedObjectStoreImpl::UnWatch object err ");
+        return ERR_NULL_OBJECTSTORE;
+    }
+    std::lock_guard<std::mutex> lock(watcherMutex_);
+    auto iter = watchers_.find(object);
+    if (iter == watchers_.end() || iter->second.count(watcher.get()) == 0) {
+        LOG_ERROR("DistributedObjectStoreImpl::UnWatch no such watcher");
+        return ERR_NO_OBSERVER;
+    }
+    uint32_t status = flatObjectStore_->UnWatch(object->GetSessionId(), iter->second.at(watcher.get()));
     if (status != SUCCESS) {
-        LOG_ERROR("DistributedObjectStoreImpl::Watch failed %{public}d", status);
+        LOG_ERROR("DistributedObjectStoreImpl::UnWatch failed %{public}d", status);
         return status;
     }
-    watchers_.erase(object);
-    LOG_INFO("DistributedObjectStoreImpl:UnWatch object success.");
+    iter->second.erase(watcher.get());
+    if (iter->second.empty()) {
+        watchers_.erase(iter);
+    }
+    LOG_INFO("DistributedObjectStoreImpl:UnWatch watcher success.");
     return SUCCESS;
 }
 
 void DistributedObjectStoreImpl::TriggerSync()
 {
+    TriggerSync([](const std::map<std::string, uint32_t> &results) {
+        for (auto &item : results) {
+            if (item.second != SUCCESS) {
+                LOG_WARN("%{public}s push result %{public}u", item.first.c_str(), item.second);
+            }
+        }
+        LOG_INFO("push end, %{public}zu sessions", results.size());
+    });
+}
+
+uint32_t DistributedObjectStoreImpl::TriggerSync(
+    const std::function<void(const std::map<std::string, uint32_t> &results)> &callback)
+{
+    if (flatObjectStore_ == nullptr) {
+        LOG_ERROR("DistributedObjectStoreImpl::TriggerSync store not opened!");
+        return ERR_NULL_OBJECTSTORE;
+    }
+    flatObjectStore_->PushAll(callback);
+    return SUCCESS;
 }
 
 void DistributedObjectStoreImpl::TriggerRestore(std::function<void()> notifier)
 {
-    std::thread th = std::thread([=]() {
-        bool isFinished;
-        int16_t i;
-        constexpr static int16_t MAX_RETRY_SIZE = 5000;
-        std::map<std::string, SyncStatus> syncStatus;
+    TriggerRestore(RestoreCoordinator::RESTORE_TIMEOUT, [notifier](uint32_t) {
+        if (notifier != nullptr) {
+            notifier();
+        }
+    });
+}
+
+uint32_t DistributedObjectStoreImpl::TriggerRestore(
+    std::chrono::milliseconds timeout, const std::function<void(uint32_t status)> &notifier)
+{
+    if (notifier == nullptr) {
+        LOG_ERROR("DistributedObjectStoreImpl::TriggerRestore notifier is null");
+        return ERR_INVALID_ARGS;
+    }
+    std::vector<std::string> sessionIds;
+    {
+        std::shared_lock<std::shared_mutex> cacheLock(dataMutex_);
         for (auto &item : objects_) {
-            syncStatus[item->GetSessionId()] = SYNC_START;
+            sessionIds.push_back(item.first);
         }
-        for (i = 0; i < MAX_RETRY_SIZE; i++) {
-            {
-                std::unique_lock<std::shared_mutex> cacheLock(dataMutex_);
-                for (auto &item : objects_) {
-                    if (syncStatus[item->GetSessionId()] != SYNC_SUCCESS
-                        && syncStatus[item->GetSessionId()] != SYNCING) {
-                        auto onComplete = [this, item, &syncStatus](
-                                              const std::map<std::string, DistributedDB::DBStatus> &devices) {
-                            LOG_INFO("%{public}s pull data", item->GetSessionId().c_str());
-                            std::unique_lock<std::shared_mutex> cacheLock(dataMutex_);
-                            SyncStatus result = SYNC_SUCCESS;
-                            for (auto device : devices) {
-                                if (device.second != DistributedDB::OK) {
-                                    result = SYNC_FAIL;
-                                    LOG_ERROR("%{public}s pull data fail %{public}d in device %{public}s",
-                                        item->GetSessionId().c_str(), device.second,
-                                        SoftBusAdapter::GetInstance()->ToNodeID(device.first).c_str());
-                                }
-                            }
-                            LOG_INFO("%{public}s pull data success", item->GetSessionId().c_str());
-                            syncStatus[item->GetSessionId()] = result;
-                        };
-                        LOG_INFO("start sync %{public}s", item->GetSessionId().c_str());
-                        uint32_t result = flatObjectStore_->SyncAllData(item->GetSessionId(), onComplete);
-                        if (result == SUCCESS) {
-                            syncStatus[item->GetSessionId()] = SYNCING;
-                        } else if (result == ERR_SINGLE_DEVICE) {
-                            // single device, do not retry
-                            syncStatus[item->GetSessionId()] = SYNC_SUCCESS;
+    }
+    FlatObjectStore *flatObjectStore = flatObjectStore_;
+    RestoreCoordinator::SyncFunc sync = nullptr;
+    if (flatObjectStore != nullptr) {
+        sync = [flatObjectStore](const std::string &sessionId, const RestoreCoordinator::SyncDone &done) {
+            return flatObjectStore->SyncAllData(
+                sessionId, [sessionId, done](const std::map<std::string, DistributedDB::DBStatus> &devices) {
+                    bool isSuccess = true;
+                    for (auto &device : devices) {
+                        if (device.second != DistributedDB::OK) {
+                            isSuccess = false;
+                            LOG_ERROR("%{public}s pull data fail %{public}d in device %{public}s", sessionId.c_str(),
+                                device.second, SoftBusAdapter::GetInstance()->ToNodeID(device.first).c_str());
                         }
                     }
-                }
-            }
-
-            isFinished = true;
-            for (auto &item : syncStatus) {
-                if (item.second != SYNC_SUCCESS) {
-                    LOG_INFO("%{public}s not ready", item.first.c_str());
-                    isFinished = false;
-                    break;
-                }
-            }
-            if (!isFinished) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-        }
-        LOG_WARN("restore result");
-        notifier();
-        LOG_WARN("notify end");
-    });
-    th.detach();
-    return;
+                    done(isSuccess);
+                });
+        };
+    }
+    auto coordinator =
+        std::make_shared<RestoreCoordinator>(sync, notifier, RestoreCoordinator::INITIAL_BACKOFF, timeout);
+    coordinator->Start(sessionIds);
+    return SUCCESS;
 }
+
 uint32_t DistributedObjectStoreImpl::SetStatusNotifier(std::shared_ptr<StatusNotifier> notifier)
 {
     if (flatObjectStore_ == nullptr) {
@@ -233,6 +296,28 @@ uint32_t DistributedObjectStoreImpl::SetStatusNotifier(std::shared_ptr<StatusNot
     return status;
 }
 
+uint32_t DistributedObjectStoreImpl::SaveAll(const std::vector<std::string> &sessionIds, const std::string &deviceId,
+    const std::function<void(const std::map<std::string, uint32_t> &results)> &callback)
+{
+    if (flatObjectStore_ == nullptr) {
+        LOG_ERROR("DistributedObjectStoreImpl::SaveAll store not opened!");
+        return ERR_NULL_OBJECTSTORE;
+    }
+    flatObjectStore_->SaveAll(sessionIds, deviceId, callback);
+    return SUCCESS;
+}
+
+uint32_t DistributedObjectStoreImpl::RetrieveAll(const std::vector<std::string> &sessionIds,
+    const std::function<void(const std::map<std::string, uint32_t> &results)> &callback)
+{
+    if (flatObjectStore_ == nullptr) {
+        LOG_ERROR("DistributedObjectStoreImpl::RetrieveAll store not opened!");
+        return ERR_NULL_OBJECTSTORE;
+    }
+    flatObjectStore_->RetrieveAll(sessionIds, callback);
+    return SUCCESS;
+}
+
 WatcherProxy::WatcherProxy(const std::shared_ptr<ObjectWatcher> objectWatcher, const std::string &sessionId)
     : FlatObjectWatcher(sessionId), objectWatcher_(objectWatcher)
 {
@@ -246,20 +331,31 @@ void WatcherProxy::OnChanged(const std::string &sessionid, const std::vector<std
 DistributedObjectStore *DistributedObjectStore::GetInstance(const std::string &bundleName)
 {
     static std::mutex instLock_;
-    static DistributedObjectStore *instPtr = nullptr;
-    if (instPtr == nullptr) {
-        std::lock_guard<std::mutex> lock(instLock_);
-        if (instPtr == nullptr && !bundleName.empty()) {
-            LOG_INFO("new objectstore %{public}s", bundleName.c_str());
-            FlatObjectStore *flatObjectStore = new (std::nothrow) FlatObjectStore(bundleName);
-            if (flatObjectStore == nullptr) {
-                LOG_ERROR("no memory for FlatObjectStore malloc!");
-                return nullptr;
-            }
-            // Use instMemory to make sure this singleton not free before other object.
-            // This operation needn't to malloc memory, we needn't to check nullptr.
-            instPtr = new DistributedObjectStoreImpl(flatObjectStore);
-        }
+    // one store per bundle, an empty bundle name gets the first store created
+    static std::map<std::string, DistributedObjectStore *> instances;
+    static DistributedObjectStore *defaultInst = nullptr;
+    std::lock_guard<std::mutex> lock(instLock_);
+    if (bundleName.empty()) {
+        return defaultInst;
+    }
+    auto iter = instances.find(bundleName);
+    if (iter != instances.end()) {
+        return iter->second;
+    }
+    LOG_INFO("new objectstore %{public}s", bundleName.c_str());
+    // look the data service up while the storage engine opens
+    ClientAdaptor::Prefetch();
+    FlatObjectStore *flatObjectStore = new (std::nothrow) FlatObjectStore(bundleName);
+    if (flatObjectStore == nullptr) {
+        LOG_ERROR("no memory for FlatObjectStore malloc!");
+        return nullptr;
+    }
+    // Use instMemory to make sure this singleton not free before other object.
+    // This operation needn't to malloc memory, we needn't to check nullptr.
+    DistributedObjectStore *instPtr = new DistributedObjectStoreImpl(flatObjectStore);
+    instances[bundleName] = instPtr;
+    if (defaultInst == nullptr) {
+        defaultInst = instPtr;
     }
     return instPtr;
 }
@@ -14,6 +14,8 @@
  */
 #include "flat_object_storage_engine.h"
 
+#include <algorithm>
+
 #include "logger.h"
 #include "objectstore_errors.h"
 #include "process_communicator_impl.h"
@@ -38,17 +40,9 @@ uint32_t FlatObjectStorageEngine::Open(const std::string &bundleName)
         LOG_INFO("FlatObjectDatabase: No need to reopen it");
         return SUCCESS;
     }
-    auto status = DistributedDB::KvStoreDelegateManager::SetProcessLabel("objectstoreDB", bundleName);
-    if (status != DistributedDB::DBStatus::OK) {
-        LOG_ERROR("delegate SetProcessLabel failed: %{public}d.", static_cast<int>(status));
-        return ERR_DB_SET_PROCESS;
-    }
-
-    auto communicator = std::make_shared<ProcessCommunicatorImpl>();
-    auto commStatus = DistributedDB::KvStoreDelegateManager::SetProcessCommunicator(communicator);
-    if (commStatus != DistributedDB::DBStatus::OK) {
-        LOG_ERROR("set distributed db communicator failed.");
-        return ERR_DB_SET_PROCESS;
+    uint32_t ret = InitProcess(bundleName);
+    if (ret != SUCCESS) {
+        return ret;
     }
     storeManager_ = std::make_shared<DistributedDB::KvStoreDelegateManager>(bundleName, "default");
     if (storeManager_ == nullptr) {
@@ -59,11 +53,36 @@ uint32_t FlatObjectStorageEngine::Open(const std::string &bundleName)
     DistributedDB::KvStoreConfig config;
     config.dataDir = "/data/log";
     storeManager_->SetKvStoreConfig(config);
+    clock_.SetNodeId(SoftBusAdapter::GetInstance()->GetLocalDevice().deviceId);
     isOpened_ = true;
     LOG_INFO("FlatObjectDatabase::Open Succeed");
     return SUCCESS;
 }
 
+uint32_t FlatObjectStorageEngine::InitProcess(const std::string &bundleName)
+{
+    static std::mutex initMutex;
+    static std::shared_ptr<ProcessCommunicatorImpl> communicator = nullptr;
+    std::lock_guard<std::mutex> lock(initMutex);
+    if (communicator != nullptr) {
+        LOG_INFO("process communicator already set, %{public}s shares it", bundleName.c_str());
+        return SUCCESS;
+    }
+    auto status = DistributedDB::KvStoreDelegateManager::SetProcessLabel("objectstoreDB", bundleName);
+    if (status != DistributedDB::DBStatus::OK) {
+        LOG_ERROR("delegate SetProcessLabel failed: %{public}d.", static_cast<int>(status));
+        return ERR_DB_SET_PROCESS;
+    }
+    auto processCommunicator = std::make_shared<ProcessCommunicatorImpl>();
+    auto commStatus = DistributedDB::KvStoreDelegateManager::SetProcessCommunicator(processCommunicator);
+    if (commStatus != DistributedDB::DBStatus::OK) {
+        LOG_ERROR("set distributed db communicator failed.");
+        return ERR_DB_SET_PROCESS;
+    }
+    communicator = processCommunicator;
+    return SUCCESS;
+}
+
 uint32_t FlatObjectStorageEngine::Close()
 {
     if (!isOpened_) {
@@ -107,10 +126,30 @@ uint32_t FlatObjectStorageEngine::CreateTable(const std::string &key)
         LOG_ERROR("FlatObjectStorageEngine::CreateTable %{public}s getkvstore fail[%{public}d]", key.c_str(), status);
         return ERR_DB_GETKV_FAIL;
     }
+    // the value a remote write overwrites is only kept while it may still win, see OnConflict
+    status = kvStore->SetConflictNotifier(DistributedDB::CONFLICT_FOREIGN_KEY_ORIG,
+        [this, key](const DistributedDB::KvStoreNbConflictData &data) { OnConflict(key, data); });
+    if (status != DistributedDB::DBStatus::OK) {
+        LOG_WARN("FlatObjectStorageEngine::CreateTable %{public}s conflict notifier fail[%{public}d]", key.c_str(),
+            status);
+    }
+    auto observer = std::make_shared<TableObserver>(key, this);
+    std::vector<uint8_t> tmpKey;
+    status = kvStore->RegisterObserver(tmpKey, DistributedDB::ObserverMode::OBSERVER_CHANGES_FOREIGN, observer.get());
+    if (status != DistributedDB::DBStatus::OK) {
+        LOG_ERROR("FlatObjectStorageEngine::CreateTable %{public}s observe fail[%{public}d]", key.c_str(), status);
+        storeManager_->CloseKvStore(kvStore);
+        return ERR_REGISTER;
+    }
     LOG_INFO("create table %{public}s success", key.c_str());
     {
         std::lock_guard<std::mutex> lock(operationMutex_);
         delegates_.insert_or_assign(key, kvStore);
+        tableObservers_.insert_or_assign(key, observer);
+    }
+    {
+        std::lock_guard<std::mutex> lock(fieldMutex_);
+        fieldVersions_[key];
     }
 
     auto onComplete = [key, this](const std::map<std::string, DistributedDB::DBStatus> &devices) {
@@ -126,11 +165,7 @@ uint32_t FlatObjectStorageEngine::CreateTable(const std::string &key)
             }
         }
     };
-    std::vector<DeviceInfo> devices = SoftBusAdapter::GetInstance()->GetDeviceList();
-    std::vector<std::string> deviceIds;
-    for (auto item : devices) {
-        deviceIds.push_back(item.deviceId);
-    }
+    std::vector<std::string> deviceIds = SoftBusAdapter::GetInstance()->GetOnlineDevices();
     SyncAllData(key, deviceIds, onComplete);
     return SUCCESS;
 }
@@ -163,7 +198,10 @@ uint32_t FlatObjectStorageEngine::GetTable(const std::string &key, std::map<std:
             LOG_INFO("FlatObjectStorageEngine::GetTable  GetEntry fail");
             return ERR_DB_ENTRY_FAIL;
         }
-        result.insert_or_assign(StringUtils::BytesToStr(entry.key), entry.value);
+        std::string itemKey = StringUtils::BytesToStr(entry.key);
+        if (!FieldVersionCodec::IsVersionKey(itemKey)) {
+            result.insert_or_assign(itemKey, entry.value);
+        }
         resultSet->MoveToNext();
     }
     return SUCCESS;
@@ -179,15 +217,8 @@ uint32_t FlatObjectStorageEngine::UpdateItem(const std::string &key, const std::
         LOG_INFO("FlatObjectStorageEngine::GetTable %{public}s not exist", key.c_str());
         return ERR_DB_NOT_EXIST;
     }
-    auto delegate = delegates_.at(key);
     LOG_INFO("start Put");
-    auto status = delegate->Put(StringUtils::StrToBytes(itemKey), value);
-    if (status != DistributedDB::DBStatus::OK) {
-        LOG_ERROR("%{public}s Put fail[%{public}d]", key.c_str(), status);
-        return ERR_CLOSE_STORAGE;
-    }
-    LOG_INFO("put success");
-    return SUCCESS;
+    return PutFields(key, delegates_.at(key), { { itemKey, value } });
 }
 
 uint32_t FlatObjectStorageEngine::UpdateItems(
@@ -201,19 +232,49 @@ uint32_t FlatObjectStorageEngine::UpdateItems(
         LOG_INFO("FlatObjectStorageEngine::UpdateItems %{public}s not exist", key.c_str());
         return ERR_DB_NOT_EXIST;
     }
+    LOG_INFO("start PutBatch");
+    return PutFields(key, delegates_.at(key), data);
+}
 
+uint32_t FlatObjectStorageEngine::PutFields(const std::string &key, DistributedDB::KvStoreNbDelegate *delegate,
+    const std::map<std::string, std::vector<uint8_t>> &data)
+{
     std::vector<DistributedDB::Entry> entries;
+    std::map<std::string, FieldVersion> versions;
     for (auto &item : data) {
+        // versions restored from a save are stamped again below
+        if (FieldVersionCodec::IsVersionKey(item.first)) {
+            continue;
+        }
         DistributedDB::Entry entry = { .key = StringUtils::StrToBytes(item.first), .value = item.second };
         entries.emplace_back(entry);
+        if (item.first.compare(0, FIELDS_PREFIX_LEN, FIELDS_PREFIX) != 0) {
+            continue;
+        }
+        FieldVersion version = clock_.Tick();
+        DistributedDB::Entry versionEntry = { .key = StringUtils::StrToBytes(
+            FieldVersionCodec::GetVersionKey(item.first)), .value = FieldVersionCodec::Encode(version) };
+        entries.emplace_back(versionEntry);
+        versions.insert_or_assign(item.first, version);
+    }
+    if (entries.empty()) {
+        return ERR_INVALID_ARGS;
     }
-    auto delegate = delegates_.at(key);
-    LOG_INFO("start PutBatch");
     auto status = delegate->PutBatch(entries);
     if (status != DistributedDB::DBStatus::OK) {
         LOG_ERROR("%{public}s PutBatch fail[%{public}d]", key.c_str(), status);
         return ERR_CLOSE_STORAGE;
     }
+    {
+        std::lock_guard<std::mutex> lock(fieldMutex_);
+        auto &table = fieldVersions_[key];
+        for (auto &item : versions) {
+            table.Put(item.first, item.second);
+            // written again, an older value overwritten by a sync must not be written back over this one
+            DropOverwritten(key, item.first);
+        }
+    }
+    MarkUnsynced({ key });
     LOG_INFO("put success");
     return SUCCESS;
 }
@@ -229,6 +290,11 @@ uint32_t FlatObjectStorageEngine::DeleteTable(const std::string &key)
         return ERR_DB_NOT_EXIST;
     }
     LOG_INFO("start DeleteTable %{public}s", key.c_str());
+    auto observer = tableObservers_.find(key);
+    if (observer != tableObservers_.end()) {
+        delegates_.at(key)->UnRegisterObserver(observer->second.get());
+        tableObservers_.erase(observer);
+    }
     auto status = storeManager_->CloseKvStore(delegates_.at(key));
     if (status != DistributedDB::DBStatus::OK) {
         LOG_ERROR(
@@ -237,6 +303,20 @@ uint32_t FlatObjectStorageEngine::DeleteTable(const std::string &key)
     }
     LOG_INFO("DeleteTable success");
     delegates_.erase(key);
+    {
+        std::lock_guard<std::mutex> fieldLock(fieldMutex_);
+        fieldVersions_.erase(key);
+        overwritten_.erase(key);
+        writeBacks_.erase(key);
+    }
+    {
+        std::lock_guard<std::mutex> syncLock(syncMutex_);
+        unsyncedTables_.erase(key);
+    }
+    {
+        std::lock_guard<std::mutex> observerLock(observerMutex_);
+        observerMap_.erase(key);
+    }
     return SUCCESS;
 }
 
@@ -266,26 +346,27 @@ uint32_t FlatObjectStorageEngine::RegisterObserver(const std::string &key, std::
         LOG_ERROR("FlatObjectStorageEngine::RegisterObserver kvStore has not init");
         return ERR_DB_NOT_INIT;
     }
-    std::lock_guard<std::mutex> lock(operationMutex_);
-    if (delegates_.count(key) == 0) {
-        LOG_INFO("FlatObjectStorageEngine::RegisterObserver %{public}s not exist", key.c_str());
-        return ERR_DB_NOT_EXIST;
-    }
-    if (observerMap_.count(key) != 0) {
-        LOG_INFO("FlatObjectStorageEngine::RegisterObserver observer already exist.");
-        return SUCCESS;
+    {
+        std::lock_guard<std::mutex> lock(operationMutex_);
+        if (delegates_.count(key) == 0) {
+            LOG_INFO("FlatObjectStorageEngine::RegisterObserver %{public}s not exist", key.c_str());
+            return ERR_DB_NOT_EXIST;
+        }
     }
-    auto delegate = delegates_.at(key);
-    std::vector<uint8_t> tmpKey;
-    LOG_INFO("start RegisterObserver %{public}s", key.c_str());
-    DistributedDB::DBStatus status =
-        delegate->RegisterObserver(tmpKey, DistributedDB::ObserverMode::OBSERVER_CHANGES_FOREIGN, watcher.get());
-    if (status != DistributedDB::DBStatus::OK) {
-        LOG_ERROR("FlatObjectStorageEngine::RegisterObserver watch err %{public}d", status);
-        return ERR_REGISTER;
+    // changes reach every watcher through the one table observer once conflicts are resolved
+    std::lock_guard<std::mutex> lock(observerMutex_);
+    auto subscribers = std::make_shared<Subscribers>();
+    auto iter = observerMap_.find(key);
+    if (iter != observerMap_.end()) {
+        if (std::find(iter->second->begin(), iter->second->end(), watcher) != iter->second->end()) {
+            LOG_INFO("FlatObjectStorageEngine::RegisterObserver observer already exist.");
+            return SUCCESS;
+        }
+        *subscribers = *iter->second;
     }
-    LOG_INFO("end RegisterObserver %{public}s", key.c_str());
-    observerMap_.insert_or_assign(key, watcher);
+    subscribers->push_back(watcher);
+    LOG_INFO("RegisterObserver %{public}s, %{public}zu watchers", key.c_str(), subscribers->size());
+    observerMap_.insert_or_assign(key, subscribers);
     return SUCCESS;
 }
 
@@ -295,26 +376,50 @@ uint32_t FlatObjectStorageEngine::UnRegisterObserver(const std::string &key)
         LOG_ERROR("FlatObjectStorageEngine::RegisterObserver kvStore has not init");
         return ERR_DB_NOT_INIT;
     }
-    std::lock_guard<std::mutex> lock(operationMutex_);
-    if (delegates_.count(key) == 0) {
-        LOG_INFO("FlatObjectStorageEngine::RegisterObserver %{public}s not exist", key.c_str());
-        return ERR_DB_NOT_EXIST;
+    {
+        std::lock_guard<std::mutex> lock(operationMutex_);
+        if (delegates_.count(key) == 0) {
+            LOG_INFO("FlatObjectStorageEngine::RegisterObserver %{public}s not exist", key.c_str());
+            return ERR_DB_NOT_EXIST;
+        }
     }
+    std::lock_guard<std::mutex> lock(observerMutex_);
     auto iter = observerMap_.find(key);
     if (iter == observerMap_.end()) {
         LOG_ERROR("FlatObjectStorageEngine::UnRegisterObserver observer not exist.");
         return ERR_NO_OBSERVER;
     }
-    auto delegate = delegates_.at(key);
-    std::shared_ptr<TableWatcher> watcher = iter->second;
-    LOG_INFO("start UnRegisterObserver %{public}s", key.c_str());
-    DistributedDB::DBStatus status = delegate->UnRegisterObserver(watcher.get());
-    if (status != DistributedDB::DBStatus::OK) {
-        LOG_ERROR("FlatObjectStorageEngine::UnRegisterObserver unRegister err %{public}d", status);
-        return ERR_UNRIGSTER;
+    LOG_INFO("UnRegisterObserver %{public}s", key.c_str());
+    observerMap_.erase(iter);
+    return SUCCESS;
+}
+
+uint32_t FlatObjectStorageEngine::UnRegisterObserver(
+    const std::string &key, const std::shared_ptr<TableWatcher> &watcher)
+{
+    if (!isOpened_) {
+        LOG_ERROR("FlatObjectStorageEngine::UnRegisterObserver kvStore has not init");
+        return ERR_DB_NOT_INIT;
+    }
+    std::lock_guard<std::mutex> lock(observerMutex_);
+    auto iter = observerMap_.find(key);
+    if (iter == observerMap_.end()
+        || std::find(iter->second->begin(), iter->second->end(), watcher) == iter->second->end()) {
+        LOG_ERROR("FlatObjectStorageEngine::UnRegisterObserver observer not exist.");
+        return ERR_NO_OBSERVER;
+    }
+    auto subscribers = std::make_shared<Subscribers>();
+    for (auto &item : *iter->second) {
+        if (item != watcher) {
+            subscribers->push_back(item);
+        }
+    }
+    LOG_INFO("UnRegisterObserver %{public}s, %{public}zu watchers left", key.c_str(), subscribers->size());
+    if (subscribers->empty()) {
+        observerMap_.erase(iter);
+    } else {
+        iter->second = subscribers;
     }
-    LOG_INFO("end UnRegisterObserver %{public}s", key.c_str());
-    observerMap_.erase(key);
     return SUCCESS;
 }
 
@@ -398,21 +503,245 @@ uint32_t FlatObjectStorageEngine::GetItems(const std::string &key, std::map<std:
         return status;
     }
     for (auto &item : entries) {
-        data[StringUtils::BytesToStr(item.key)] = item.value;
+        std::string itemKey = StringUtils::BytesToStr(item.key);
+        if (!FieldVersionCodec::IsVersionKey(itemKey)) {
+            data[itemKey] = item.value;
+        }
     }
     LOG_INFO("end Get %{public}s", key.c_str());
     return SUCCESS;
 }
 
+bool FlatObjectStorageEngine::ResolveField(
+    const std::string &sessionId, const std::string &itemKey, const Value &version)
+{
+    FieldVersion remote;
+    bool isVersioned = FieldVersionCodec::Decode(version, remote);
+    if (isVersioned) {
+        clock_.Update(remote);
+    }
+    std::lock_guard<std::mutex> lock(fieldMutex_);
+    auto table = fieldVersions_.find(sessionId);
+    if (table == fieldVersions_.end()) {
+        return false;
+    }
+    if (!isVersioned) {
+        // written by a peer without field versions, keep the DistributedDB order
+        table->second.Remove(itemKey);
+        DropOverwritten(sessionId, itemKey);
+        return true;
+    }
+    if (table->second.Resolve(itemKey, remote)) {
+        DropOverwritten(sessionId, itemKey);
+        return true;
+    }
+    // only the device that wrote the winning version has its value, it writes it back so the peers converge
+    FieldVersion local;
+    if (table->second.Get(itemKey, local) && local.nodeId == clock_.GetNodeId()) {
+        LOG_INFO("%{public}s keeps local version of %{public}s", sessionId.c_str(), itemKey.c_str());
+        writeBacks_[sessionId].insert(itemKey);
+    }
+    return false;
+}
+
+void FlatObjectStorageEngine::OnConflict(const std::string &sessionId, const DistributedDB::KvStoreNbConflictData &data)
+{
+    using ValueType = DistributedDB::KvStoreNbConflictData::ValueType;
+    Key key;
+    data.GetKey(key);
+    std::string itemKey = StringUtils::BytesToStr(key);
+    if (itemKey.compare(0, FIELDS_PREFIX_LEN, FIELDS_PREFIX) != 0 || !data.IsNative(ValueType::OLD_VALUE)
+        || data.IsDeleted(ValueType::OLD_VALUE)) {
+        return;
+    }
+    Value value;
+    if (data.GetValue(ValueType::OLD_VALUE, value) != DistributedDB::DBStatus::OK) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(fieldMutex_);
+    auto table = fieldVersions_.find(sessionId);
+    FieldVersion local;
+    if (table == fieldVersions_.end() || !table->second.Get(itemKey, local) || local.nodeId != clock_.GetNodeId()) {
+        return;
+    }
+    overwritten_[sessionId].insert_or_assign(itemKey, std::move(value));
+}
+
+void FlatObjectStorageEngine::DropOverwritten(const std::string &sessionId, const std::string &itemKey)
+{
+    auto table = overwritten_.find(sessionId);
+    if (table == overwritten_.end()) {
+        return;
+    }
+    table->second.erase(itemKey);
+    if (table->second.empty()) {
+        overwritten_.erase(table);
+    }
+}
+
+void FlatObjectStorageEngine::ScheduleWriteBack(const std::string &sessionId)
+{
+    {
+        std::lock_guard<std::mutex> lock(fieldMutex_);
+        if (writeBacks_.count(sessionId) == 0) {
+            return;
+        }
+    }
+    writeBackScheduler_.Execute([this, sessionId]() { WriteBack(sessionId); });
+}
+
+void FlatObjectStorageEngine::WriteBack(const std::string &sessionId)
+{
+    std::lock_guard<std::mutex> lock(operationMutex_);
+    auto delegate = delegates_.find(sessionId);
+    if (delegate == delegates_.end()) {
+        return;
+    }
+    // local writes hold operationMutex_ too, the versions taken here match the overwritten values
+    std::vector<DistributedDB::Entry> entries;
+    {
+        std::lock_guard<std::mutex> fieldLock(fieldMutex_);
+        auto iter = writeBacks_.find(sessionId);
+        if (iter == writeBacks_.end()) {
+            return;
+        }
+        auto &table = fieldVersions_[sessionId];
+        auto &values = overwritten_[sessionId];
+        for (auto &itemKey : iter->second) {
+            FieldVersion version;
+            auto value = values.find(itemKey);
+            if (!table.Get(itemKey, version) || value == values.end()) {
+                LOG_INFO("%{public}s no value to write back for %{public}s", sessionId.c_str(), itemKey.c_str());
+                continue;
+            }
+            entries.push_back({ StringUtils::StrToBytes(itemKey), value->second });
+            entries.push_back({ StringUtils::StrToBytes(FieldVersionCodec::GetVersionKey(itemKey)),
+                FieldVersionCodec::Encode(version) });
+        }
+        writeBacks_.erase(iter);
+        overwritten_.erase(sessionId);
+    }
+    if (entries.empty()) {
+        return;
+    }
+    auto status = delegate->second->PutBatch(entries);
+    if (status != DistributedDB::DBStatus::OK) {
+        LOG_ERROR("%{public}s write back fail[%{public}d]", sessionId.c_str(), status);
+        return;
+    }
+    MarkUnsynced({ sessionId });
+}
+
+void FlatObjectStorageEngine::NotifyChange(const std::string &sessionId, const std::vector<std::string> &changedData)
+{
+    std::shared_ptr<const Subscribers> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(observerMutex_);
+        auto iter = observerMap_.find(sessionId);
+        if (iter == observerMap_.end()) {
+            return;
+        }
+        subscribers = iter->second;
+    }
+    for (auto &watcher : *subscribers) {
+        watcher->OnChanged(sessionId, changedData);
+    }
+}
+
+std::set<std::string> FlatObjectStorageEngine::TakeUnsyncedTables()
+{
+    std::lock_guard<std::mutex> lock(syncMutex_);
+    std::set<std::string> keys;
+    keys.swap(unsyncedTables_);
+    return keys;
+}
+
+void FlatObjectStorageEngine::MarkUnsynced(const std::set<std::string> &keys)
+{
+    std::lock_guard<std::mutex> lock(syncMutex_);
+    unsyncedTables_.insert(keys.begin(), keys.end());
+}
+
+void FlatObjectStorageEngine::PushTables(const std::set<std::string> &keys, const std::vector<std::string> &deviceIds,
+    const std::function<void(const std::string &key, uint32_t status)> &onComplete)
+{
+    for (auto &key : keys) {
+        uint32_t result = PushTable(key, deviceIds, onComplete);
+        if (result != SUCCESS) {
+            onComplete(key, result);
+        }
+    }
+}
+
+// the lock is taken per table, a long pass never holds back writes to the other tables
+uint32_t FlatObjectStorageEngine::PushTable(const std::string &key, const std::vector<std::string> &deviceIds,
+    const std::function<void(const std::string &key, uint32_t status)> &onComplete)
+{
+    std::lock_guard<std::mutex> lock(operationMutex_);
+    auto iter = delegates_.find(key);
+    if (iter == delegates_.end()) {
+        return ERR_DB_NOT_EXIST;
+    }
+    auto onPushed = [key, onComplete](const std::map<std::string, DistributedDB::DBStatus> &devices) {
+        uint32_t status = SUCCESS;
+        for (auto &device : devices) {
+            if (device.second != DistributedDB::OK) {
+                LOG_ERROR("%{public}s push fail %{public}d", key.c_str(), device.second);
+                status = ERR_SYNC_FAIL;
+            }
+        }
+        onComplete(key, status);
+    };
+    DistributedDB::DBStatus status =
+        iter->second->Sync(deviceIds, DistributedDB::SyncMode::SYNC_MODE_PUSH_ONLY, onPushed);
+    if (status != DistributedDB::DBStatus::OK) {
+        LOG_ERROR("FlatObjectStorageEngine::PushTables %{public}s sync err %{public}d", key.c_str(), status);
+        return ERR_SYNC_FAIL;
+    }
+    return SUCCESS;
+}
+
+TableObserver::TableObserver(const std::string &sessionId, FlatObjectStorageEngine *engine)
+    : Watcher(sessionId), sessionId_(sessionId), engine_(engine)
+{
+}
+
+void TableObserver::OnChanged(const std::string &sessionid, const std::vector<std::string> &changedData)
+{
+    if (!changedData.empty()) {
+        engine_->NotifyChange(sessionid, changedData);
+    }
+    engine_->ScheduleWriteBack(sessionId_);
+}
+
+bool TableObserver::Accept(
+    const std::string &key, const std::vector<uint8_t> &value, const std::vector<uint8_t> &version)
+{
+    return engine_->ResolveField(sessionId_, key, version);
+}
+
 void Watcher::OnChange(const DistributedDB::KvStoreChangedData &data)
 {
     std::vector<std::string> changedData;
     std::string tmp;
+    // a field and its version are written in one batch and arrive in the same change
+    std::map<std::string, std::vector<uint8_t>> versions;
+    for (auto entries : { &data.GetEntriesInserted(), &data.GetEntriesUpdated() }) {
+        for (auto &item : *entries) {
+            tmp = StringUtils::BytesToStr(item.key);
+            if (FieldVersionCodec::IsVersionKey(tmp)) {
+                versions.insert_or_assign(tmp.substr(VERSIONS_PREFIX_LEN), item.value);
+            }
+        }
+    }
+    std::vector<uint8_t> noVersion;
     for (DistributedDB::Entry item : data.GetEntriesInserted()) {
         tmp = StringUtils::BytesToStr(item.key);
         LOG_INFO("inserted %{public}s", tmp.c_str());
         // property key start with p_, 2 is p_ size
-        if (tmp.compare(0, FIELDS_PREFIX_LEN, FIELDS_PREFIX) == 0) {
+        auto version = versions.find(tmp);
+        if (tmp.compare(0, FIELDS_PREFIX_LEN, FIELDS_PREFIX) == 0
+            && Accept(tmp, item.value, version == versions.end() ? noVersion : version->second)) {
             changedData.push_back(tmp.substr(FIELDS_PREFIX_LEN));
         }
     }
@@ -420,7 +749,9 @@ void Watcher::OnChange(const DistributedDB::KvStoreChangedData &data)
         tmp = StringUtils::BytesToStr(item.key);
         LOG_INFO("updated %{public}s", tmp.c_str());
         // property key start with p_, 2 is p_ size
-        if (tmp.compare(0, FIELDS_PREFIX_LEN, FIELDS_PREFIX) == 0) {
+        auto version = versions.find(tmp);
+        if (tmp.compare(0, FIELDS_PREFIX_LEN, FIELDS_PREFIX) == 0
+            && Accept(tmp, item.value, version == versions.end() ? noVersion : version->second)) {
             changedData.push_back(tmp.substr(FIELDS_PREFIX_LEN));
         }
     }
@@ -15,6 +15,8 @@
 
 #include "flat_object_store.h"
 
+#include <atomic>
+
 #include "client_adaptor.h"
 #include "distributed_objectstore_impl.h"
 #include "logger.h"
@@ -22,6 +24,7 @@
 #include "object_service_proxy.h"
 #include "objectstore_errors.h"
 #include "softbus_adapter.h"
+#include "wait_statistics.h"
 
 namespace OHOS::ObjectStore {
 FlatObjectStore::FlatObjectStore(const std::string &bundleName)
@@ -56,21 +59,166 @@ uint32_t FlatObjectStore::CreateObject(const std::string &sessionId)
         LOG_ERROR("FlatObjectStore::CreateObject createTable err %{public}d", status);
         return status;
     }
-    std::function<void(const std::map<std::string, std::vector<uint8_t>> &data)> callback =
-        [sessionId, this](
-            const std::map<std::string, std::vector<uint8_t>> &data) {
-            if (data.size() > 0) {
-                LOG_INFO("objectstore, retrieve success");
-                auto result = storageEngine_->UpdateItems(sessionId, data);
-                if (result != SUCCESS) {
-                    LOG_ERROR("UpdateItems failed, status = %{public}d", result);
-                }
-            } else {
-                LOG_INFO("objectstore, retrieve empty");
+    // the saved copy is retrieved on first access, a session that is never used does not pay for the IPC
+    std::lock_guard<std::mutex> lock(retrieveMutex_);
+    pendingRetrieves_.insert_or_assign(sessionId, std::make_shared<RetrieveState>());
+    return SUCCESS;
+}
+
+void FlatObjectStore::WaitRetrieved(const std::string &sessionId)
+{
+    std::shared_ptr<RetrieveState> state;
+    bool isFirst = false;
+    {
+        std::lock_guard<std::mutex> lock(retrieveMutex_);
+        auto iter = pendingRetrieves_.find(sessionId);
+        if (iter == pendingRetrieves_.end()) {
+            return;
+        }
+        state = iter->second;
+        isFirst = !state->isStarted;
+        state->isStarted = true;
+    }
+    if (isFirst) {
+        StartRetrieve(sessionId, state);
+    }
+    uint32_t status = ERR_TIMEOUT;
+    if (!state->retrieved.WaitFor(RETRIEVE_WAIT_TIMEOUT, status)) {
+        // a copy arriving later would overwrite the writes made meanwhile, it is dropped
+        LOG_WARN("%{public}s retrieve not finished, use local data", sessionId.c_str());
+        Abandon(state);
+    }
+    std::lock_guard<std::mutex> lock(retrieveMutex_);
+    auto iter = pendingRetrieves_.find(sessionId);
+    if (iter != pendingRetrieves_.end() && iter->second == state) {
+        pendingRetrieves_.erase(iter);
+    }
+}
+
+void FlatObjectStore::StartRetrieve(const std::string &sessionId, const std::shared_ptr<RetrieveState> &state)
+{
+    if (cacheManager_ == nullptr) {
+        LOG_ERROR("FlatObjectStore::cacheManager_ is null");
+        state->retrieved.Notify(ERR_NULL_PTR);
+        return;
+    }
+    // the callback may come after the store is gone, it holds the engine and the state only
+    std::function<void(const std::map<std::string, std::vector<uint8_t>> &data)> onRetrieved =
+        [storageEngine = storageEngine_, sessionId, state](const std::map<std::string, std::vector<uint8_t>> &data) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->isAbandoned) {
+                LOG_WARN("%{public}s retrieve answered too late, drop the retrieved data", sessionId.c_str());
+                return;
             }
+            uint32_t status = ApplyRetrieved(storageEngine, sessionId, data);
+            LOG_INFO("%{public}s retrieve end, status = %{public}d", sessionId.c_str(), status);
+            state->retrieved.Notify(status);
         };
-    cacheManager_->ResumeObject(bundleName_, sessionId, callback);
-    return SUCCESS;
+    int32_t status = cacheManager_->ResumeObject(bundleName_, sessionId, onRetrieved);
+    if (status != SUCCESS) {
+        state->retrieved.Notify(status);
+    }
+}
+
+void FlatObjectStore::Abandon(const std::shared_ptr<RetrieveState> &state)
+{
+    // waits for a callback already applying the data
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->isAbandoned = true;
+}
+
+uint32_t FlatObjectStore::ApplyRetrieved(const std::shared_ptr<FlatObjectStorageEngine> &storageEngine,
+    const std::string &sessionId, const std::map<std::string, std::vector<uint8_t>> &data)
+{
+    if (data.size() == 0) {
+        LOG_INFO("objectstore, retrieve empty");
+        return SUCCESS;
+    }
+    LOG_INFO("objectstore, retrieve success");
+    auto result = storageEngine->UpdateItems(sessionId, data);
+    if (result != SUCCESS) {
+        LOG_ERROR("UpdateItems failed, status = %{public}d", result);
+    }
+    return result;
+}
+
+void FlatObjectStore::RetrieveAsync(const std::string &sessionId, const CacheManager::SaveCallback &callback)
+{
+    if (cacheManager_ == nullptr) {
+        LOG_ERROR("FlatObjectStore::cacheManager_ is null");
+        callback(ERR_NULL_PTR);
+        return;
+    }
+    std::function<void(const std::map<std::string, std::vector<uint8_t>> &data)> onRetrieved =
+        [storageEngine = storageEngine_, sessionId, callback](const std::map<std::string, std::vector<uint8_t>> &data) {
+            callback(ApplyRetrieved(storageEngine, sessionId, data));
+        };
+    int32_t status = cacheManager_->ResumeObject(bundleName_, sessionId, onRetrieved);
+    if (status != SUCCESS) {
+        callback(status);
+    }
+}
+
+void FlatObjectStore::SaveAll(
+    const std::vector<std::string> &sessionIds, const std::string &deviceId, const BatchCallback &callback)
+{
+    std::set<std::string> sessions(sessionIds.begin(), sessionIds.end());
+    if (sessions.empty()) {
+        callback({});
+        return;
+    }
+    auto collect = CollectResults<uint32_t>(sessions.size(), callback);
+    for (auto &sessionId : sessions) {
+        SaveAsync(sessionId, deviceId, [sessionId, collect](uint32_t status) { collect(sessionId, status); });
+    }
+}
+
+void FlatObjectStore::RetrieveAll(const std::vector<std::string> &sessionIds, const BatchCallback &callback)
+{
+    std::set<std::string> sessions(sessionIds.begin(), sessionIds.end());
+    if (sessions.empty()) {
+        callback({});
+        return;
+    }
+    auto collect = CollectResults<uint32_t>(sessions.size(), callback);
+    for (auto &sessionId : sessions) {
+        RetrieveAsync(sessionId, [sessionId, collect](uint32_t status) { collect(sessionId, status); });
+    }
+}
+
+void FlatObjectStore::PushAll(const BatchCallback &callback)
+{
+    if (!storageEngine_->isOpened_) {
+        LOG_ERROR("FlatObjectStore::DB has not inited");
+        callback({});
+        return;
+    }
+    std::set<std::string> sessionIds = storageEngine_->TakeUnsyncedTables();
+    if (sessionIds.empty()) {
+        callback({});
+        return;
+    }
+    std::vector<std::string> deviceIds = SoftBusAdapter::GetInstance()->GetOnlineDevices();
+    if (deviceIds.empty()) {
+        LOG_INFO("single device, keep %{public}zu sessions for the next push", sessionIds.size());
+        storageEngine_->MarkUnsynced(sessionIds);
+        std::map<std::string, uint32_t> results;
+        for (auto &sessionId : sessionIds) {
+            results[sessionId] = ERR_SINGLE_DEVICE;
+        }
+        callback(results);
+        return;
+    }
+    LOG_INFO("push %{public}zu sessions to %{public}zu devices", sessionIds.size(), deviceIds.size());
+    auto collect = CollectResults<uint32_t>(sessionIds.size(), callback);
+    std::weak_ptr<FlatObjectStorageEngine> engine = storageEngine_;
+    storageEngine_->PushTables(sessionIds, deviceIds, [engine, collect](const std::string &sessionId, uint32_t status) {
+        auto storageEngine = engine.lock();
+        if (status != SUCCESS && status != ERR_DB_NOT_EXIST && storageEngine != nullptr) {
+            storageEngine->MarkUnsynced({ sessionId });
+        }
+        collect(sessionId, status);
+    });
 }
 
 uint32_t FlatObjectStore::Delete(const std::string &sessionId)
@@ -84,6 +232,19 @@ uint32_t FlatObjectStore::Delete(const std::string &sessionId)
         LOG_ERROR("FlatObjectStore: Failed to delete object %{public}d", status);
         return status;
     }
+    std::shared_ptr<RetrieveState> state;
+    {
+        std::lock_guard<std::mutex> lock(retrieveMutex_);
+        auto iter = pendingRetrieves_.find(sessionId);
+        if (iter != pendingRetrieves_.end()) {
+            state = iter->second;
+            pendingRetrieves_.erase(iter);
+        }
+    }
+    if (state != nullptr) {
+        // a late copy must not land in a table created again under the same session id
+        Abandon(state);
+    }
     return SUCCESS;
 }
 
@@ -113,12 +274,27 @@ uint32_t FlatObjectStore::UnWatch(const std::string &sessionId)
     return status;
 }
 
+uint32_t FlatObjectStore::UnWatch(const std::string &sessionId, const std::shared_ptr<FlatObjectWatcher> &watcher)
+{
+    if (!storageEngine_->isOpened_) {
+        LOG_ERROR("FlatObjectStore::DB has not inited");
+        return ERR_DB_NOT_INIT;
+    }
+    uint32_t status = storageEngine_->UnRegisterObserver(sessionId, watcher);
+    if (status != SUCCESS) {
+        LOG_ERROR("FlatObjectStore::UnWatch failed %{public}d", status);
+    }
+    return status;
+}
+
 uint32_t FlatObjectStore::Put(const std::string &sessionId, const std::string &key, std::vector<uint8_t> value)
 {
     if (!storageEngine_->isOpened_) {
         LOG_ERROR("FlatObjectStore::DB has not inited");
         return ERR_DB_NOT_INIT;
     }
+    // the retrieved copy is older than this write, it must land first
+    WaitRetrieved(sessionId);
     return storageEngine_->UpdateItem(sessionId, key, value);
 }
 
@@ -128,6 +304,7 @@ uint32_t FlatObjectStore::Get(std::string &sessionId, const std::string &key, By
         LOG_ERROR("FlatObjectStore::DB has not inited");
         return ERR_DB_NOT_INIT;
     }
+    WaitRetrieved(sessionId);
     return storageEngine_->GetItem(sessionId, key, value);
 }
 
@@ -147,11 +324,7 @@ uint32_t FlatObjectStore::SyncAllData(const std::string &sessionId,
         LOG_ERROR("FlatObjectStore::DB has not inited");
         return ERR_DB_NOT_INIT;
     }
-    std::vector<DeviceInfo> devices = SoftBusAdapter::GetInstance()->GetDeviceList();
-    std::vector<std::string> deviceIds;
-    for (auto item : devices) {
-        deviceIds.push_back(item.deviceId);
-    }
+    std::vector<std::string> deviceIds = SoftBusAdapter::GetInstance()->GetOnlineDevices();
     return storageEngine_->SyncAllData(sessionId, deviceIds, onComplete);
 }
 
@@ -161,13 +334,65 @@ uint32_t FlatObjectStore::Save(const std::string &sessionId, const std::string &
         LOG_ERROR("FlatObjectStore::cacheManager_ is null");
         return ERR_NULL_PTR;
     }
+    WaitRetrieved(sessionId);
     std::map<std::string, std::vector<uint8_t>> objectData;
     uint32_t status = storageEngine_->GetItems(sessionId, objectData);
     if (status != SUCCESS) {
         LOG_ERROR("FlatObjectStore::GetItems fail");
         return status;
     }
-    return cacheManager_->Save(bundleName_, sessionId, deviceId, objectData);
+    return cacheManager_->Save(bundleName_, sessionId, deviceId, std::move(objectData));
+}
+
+void FlatObjectStore::SaveAsync(
+    const std::string &sessionId, const std::string &deviceId, const CacheManager::SaveCallback &callback)
+{
+    if (cacheManager_ == nullptr) {
+        LOG_ERROR("FlatObjectStore::cacheManager_ is null");
+        callback(ERR_NULL_PTR);
+        return;
+    }
+    WaitRetrieved(sessionId);
+    std::map<std::string, std::vector<uint8_t>> objectData;
+    uint32_t status = storageEngine_->GetItems(sessionId, objectData);
+    if (status != SUCCESS) {
+        LOG_ERROR("FlatObjectStore::GetItems fail");
+        callback(status);
+        return;
+    }
+    cacheManager_->SaveAsync(bundleName_, sessionId, deviceId, std::move(objectData), callback);
+}
+
+uint32_t FlatObjectStore::Save(
+    const std::string &sessionId, const std::vector<std::string> &deviceIds, std::map<std::string, int32_t> &results)
+{
+    if (cacheManager_ == nullptr) {
+        LOG_ERROR("FlatObjectStore::cacheManager_ is null");
+        return ERR_NULL_PTR;
+    }
+    std::set<std::string> devices(deviceIds.begin(), deviceIds.end());
+    if (devices.empty()) {
+        LOG_ERROR("FlatObjectStore::Save no target device");
+        return ERR_INVALID_ARGS;
+    }
+    WaitRetrieved(sessionId);
+    std::map<std::string, std::vector<uint8_t>> objectData;
+    uint32_t status = storageEngine_->GetItems(sessionId, objectData);
+    if (status != SUCCESS) {
+        LOG_ERROR("FlatObjectStore::GetItems fail");
+        return status;
+    }
+    status = cacheManager_->Save(bundleName_, sessionId, std::vector<std::string>(devices.begin(), devices.end()),
+        std::move(objectData), results);
+    if (status == SUCCESS) {
+        for (auto &item : results) {
+            if (item.second != SUCCESS) {
+                status = ERR_DB_GET_FAIL;
+                break;
+            }
+        }
+    }
+    return status;
 }
 
 uint32_t FlatObjectStore::RevokeSave(const std::string &sessionId)
@@ -184,46 +409,204 @@ CacheManager::CacheManager()
 }
 
 uint32_t CacheManager::Save(const std::string &bundleName, const std::string &sessionId, const std::string &deviceId,
-    const std::map<std::string, std::vector<uint8_t>> &objectData)
+    std::map<std::string, std::vector<uint8_t>> objectData, std::chrono::milliseconds timeout,
+    std::shared_ptr<CancellationToken> token)
 {
-    std::unique_lock<std::mutex> lck(mutex_);
-    ConditionLock<int32_t> conditionLock;
-    int32_t status = SaveObject(bundleName, sessionId, deviceId, objectData,
-        [this, &deviceId, &conditionLock](const std::map<std::string, int32_t> &results) {
-            LOG_INFO("CacheManager::task callback");
-            if (results.count(deviceId) != 0) {
-                conditionLock.Notify(results.at(deviceId));
-            } else {
-                conditionLock.Notify(ERR_DB_GET_FAIL);
-            }
-        });
-    if (status != SUCCESS) {
-        LOG_ERROR("SaveObject failed");
-        return status;
+    if (token == nullptr) {
+        token = std::make_shared<CancellationToken>();
+    }
+    auto conditionLock = std::make_shared<ConditionLock<uint32_t>>();
+    SaveAsync(bundleName, sessionId, deviceId, std::move(objectData),
+        [conditionLock](uint32_t status) { conditionLock->Notify(status); }, token);
+    return WaitResult("save", conditionLock, timeout, token);
+}
+
+uint32_t CacheManager::RevokeSave(const std::string &bundleName, const std::string &sessionId,
+    std::chrono::milliseconds timeout, std::shared_ptr<CancellationToken> token)
+{
+    if (token == nullptr) {
+        token = std::make_shared<CancellationToken>();
     }
+    auto conditionLock = std::make_shared<ConditionLock<uint32_t>>();
+    RevokeSaveAsync(
+        bundleName, sessionId, [conditionLock](uint32_t status) { conditionLock->Notify(status); }, token);
+    return WaitResult("revoke save", conditionLock, timeout, token);
+}
+
+uint32_t CacheManager::WaitResult(const std::string &name,
+    const std::shared_ptr<ConditionLock<uint32_t>> &conditionLock, std::chrono::milliseconds timeout,
+    const std::shared_ptr<CancellationToken> &token)
+{
     LOG_INFO("CacheManager::start wait");
-    status = conditionLock.Wait();
+    auto start = std::chrono::steady_clock::now();
+    uint32_t status = ERR_TIMEOUT;
+    bool isNotified = conditionLock->WaitFor(timeout, status);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    if (!isNotified) {
+        LOG_ERROR("CacheManager::%{public}s timeout after %{public}lld ms", name.c_str(),
+            static_cast<long long>(elapsed.count()));
+        token->Cancel();
+        WaitStatistics::GetInstance().Record(name, elapsed, WaitStatistics::TIMEOUT);
+        return ERR_TIMEOUT;
+    }
+    WaitStatistics::GetInstance().Record(
+        name, elapsed, status == ERR_CANCELED ? WaitStatistics::CANCELED : WaitStatistics::COMPLETED);
     LOG_INFO("CacheManager::end wait, %{public}d", status);
-    return status == SUCCESS ? status : ERR_DB_GET_FAIL;
+    return status;
 }
 
-uint32_t CacheManager::RevokeSave(const std::string &bundleName, const std::string &sessionId)
+void CacheManager::SaveAsync(const std::string &bundleName, const std::string &sessionId,
+    const std::string &deviceId, std::map<std::string, std::vector<uint8_t>> objectData,
+    const SaveCallback &callback, std::shared_ptr<CancellationToken> token)
 {
-    std::unique_lock<std::mutex> lck(mutex_);
-    ConditionLock<int32_t> conditionLock;
-    std::function<void(int32_t)> callback = [this, &conditionLock](int32_t result) {
-        LOG_INFO("CacheManager::task callback");
-        conditionLock.Notify(result);
+    SaveCallback reply = ReplyOnce(callback, token);
+    taskQueue_.Schedule(sessionId, [this, bundleName, sessionId, deviceId, objectData = std::move(objectData), reply,
+        token](const std::function<void()> &done) {
+        std::function<void()> release = ReleaseOnce(done, token);
+        if (token != nullptr && token->IsCancelled()) {
+            return;
+        }
+        int32_t status = SaveObject(bundleName, sessionId, deviceId, objectData,
+            [deviceId, reply, release](const std::map<std::string, int32_t> &results) {
+                LOG_INFO("CacheManager::task callback");
+                auto iter = results.find(deviceId);
+                reply((iter != results.end() && iter->second == SUCCESS) ? SUCCESS : ERR_DB_GET_FAIL);
+                release();
+            });
+        if (status != SUCCESS) {
+            LOG_ERROR("SaveObject failed");
+            reply(status);
+            release();
+        }
+    });
+}
+
+uint32_t CacheManager::Save(const std::string &bundleName, const std::string &sessionId,
+    const std::vector<std::string> &deviceIds, std::map<std::string, std::vector<uint8_t>> objectData,
+    std::map<std::string, int32_t> &results, std::chrono::milliseconds timeout)
+{
+    auto token = std::make_shared<CancellationToken>();
+    auto conditionLock = std::make_shared<ConditionLock<std::map<std::string, int32_t>>>();
+    SaveAsync(bundleName, sessionId, deviceIds, std::move(objectData),
+        [conditionLock](const std::map<std::string, int32_t> &results) { conditionLock->Notify(results); }, token);
+    LOG_INFO("CacheManager::start wait");
+    auto start = std::chrono::steady_clock::now();
+    bool isNotified = conditionLock->WaitFor(timeout, results);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    WaitStatistics::GetInstance().Record(
+        "save to devices", elapsed, isNotified ? WaitStatistics::COMPLETED : WaitStatistics::TIMEOUT);
+    if (!isNotified) {
+        LOG_ERROR("CacheManager::save to devices timeout after %{public}lld ms",
+            static_cast<long long>(elapsed.count()));
+        token->Cancel();
+        for (auto &deviceId : deviceIds) {
+            results[deviceId] = ERR_TIMEOUT;
+        }
+        return ERR_TIMEOUT;
+    }
+    LOG_INFO("CacheManager::end wait");
+    return SUCCESS;
+}
+
+void CacheManager::SaveAsync(const std::string &bundleName, const std::string &sessionId,
+    const std::vector<std::string> &deviceIds, std::map<std::string, std::vector<uint8_t>> objectData,
+    const SaveResultsCallback &callback, std::shared_ptr<CancellationToken> token)
+{
+    auto replied = std::make_shared<std::atomic<bool>>(false);
+    SaveResultsCallback reply = [callback, replied](const std::map<std::string, int32_t> &results) {
+        if (!replied->exchange(true)) {
+            callback(results);
+        }
     };
-    int32_t status = RevokeSaveObject(bundleName, sessionId, callback);
-    if (status != SUCCESS) {
-        LOG_ERROR("RevokeSaveObject failed");
-        return status;
+    if (token != nullptr) {
+        token->OnCancel([reply, deviceIds]() {
+            std::map<std::string, int32_t> results;
+            for (auto &deviceId : deviceIds) {
+                results[deviceId] = ERR_CANCELED;
+            }
+            reply(results);
+        });
     }
-    LOG_INFO("CacheManager::start wait");
-    status = conditionLock.Wait();
-    LOG_INFO("CacheManager::end wait, %{public}d", status);
-    return status == SUCCESS ? status : ERR_DB_GET_FAIL;
+    // every device reads the same snapshot
+    auto payload = std::make_shared<const std::map<std::string, std::vector<uint8_t>>>(std::move(objectData));
+    taskQueue_.Schedule(sessionId, [this, bundleName, sessionId, deviceIds, payload, reply, token](
+        const std::function<void()> &done) {
+        std::function<void()> release = ReleaseOnce(done, token);
+        if (token != nullptr && token->IsCancelled()) {
+            return;
+        }
+        auto collect = CollectResults<int32_t>(
+            deviceIds.size(), [reply, release](const std::map<std::string, int32_t> &results) {
+                reply(results);
+                release();
+            });
+        for (auto &deviceId : deviceIds) {
+            int32_t status = SaveObject(bundleName, sessionId, deviceId, *payload,
+                [deviceId, collect](const std::map<std::string, int32_t> &results) {
+                    auto iter = results.find(deviceId);
+                    collect(deviceId, iter != results.end() ? iter->second : static_cast<int32_t>(ERR_DB_GET_FAIL));
+                });
+            if (status != SUCCESS) {
+                LOG_ERROR("SaveObject failed");
+                collect(deviceId, status);
+            }
+        }
+    });
+}
+
+void CacheManager::RevokeSaveAsync(const std::string &bundleName, const std::string &sessionId,
+    const SaveCallback &callback, std::shared_ptr<CancellationToken> token)
+{
+    SaveCallback reply = ReplyOnce(callback, token);
+    taskQueue_.Schedule(sessionId, [this, bundleName, sessionId, reply, token](const std::function<void()> &done) {
+        std::function<void()> release = ReleaseOnce(done, token);
+        if (token != nullptr && token->IsCancelled()) {
+            return;
+        }
+        std::function<void(int32_t)> onRevoked = [reply, release](int32_t result) {
+            LOG_INFO("CacheManager::task callback");
+            reply(result == SUCCESS ? SUCCESS : ERR_DB_GET_FAIL);
+            release();
+        };
+        int32_t status = RevokeSaveObject(bundleName, sessionId, onRevoked);
+        if (status != SUCCESS) {
+            LOG_ERROR("RevokeSaveObject failed");
+            reply(status);
+            release();
+        }
+    });
+}
+
+// the caller hears ERR_CANCELED as soon as the token is cancelled, a late service answer is dropped
+CacheManager::SaveCallback CacheManager::ReplyOnce(
+    const SaveCallback &callback, const std::shared_ptr<CancellationToken> &token)
+{
+    auto replied = std::make_shared<std::atomic<bool>>(false);
+    SaveCallback reply = [callback, replied](uint32_t status) {
+        if (!replied->exchange(true)) {
+            callback(status);
+        }
+    };
+    if (token != nullptr) {
+        token->OnCancel([reply]() { reply(ERR_CANCELED); });
+    }
+    return reply;
+}
+
+// a running task gives its place in the session queue back when cancelled, not when the service answers
+std::function<void()> CacheManager::ReleaseOnce(
+    const std::function<void()> &done, const std::shared_ptr<CancellationToken> &token)
+{
+    auto released = std::make_shared<std::atomic<bool>>(false);
+    std::function<void()> release = [done, released]() {
+        if (!released->exchange(true)) {
+            done();
+        }
+    };
+    if (token != nullptr) {
+        token->OnCancel(release);
+    }
+    return release;
 }
 
 int32_t CacheManager::SaveObject(const std::string &bundleName, const std::string &sessionId,
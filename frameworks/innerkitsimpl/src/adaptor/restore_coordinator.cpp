@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "restore_coordinator.h"
+
+#include <algorithm>
+
+#include "logger.h"
+#include "objectstore_errors.h"
+
+namespace OHOS::ObjectStore {
+RestoreCoordinator::RestoreCoordinator(const SyncFunc &sync, const Notifier &notifier,
+    std::chrono::milliseconds initialBackoff, std::chrono::milliseconds timeout)
+    : sync_(sync), notifier_(notifier), initialBackoff_(initialBackoff), timeout_(timeout)
+{
+}
+
+void RestoreCoordinator::Start(const std::vector<std::string> &sessionIds)
+{
+    std::vector<std::string> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &sessionId : sessionIds) {
+            syncStatus_[sessionId] = SYNC_START;
+        }
+        for (auto &item : syncStatus_) {
+            pending.push_back(item.first);
+        }
+        outstanding_ = pending.size();
+    }
+    if (pending.empty()) {
+        LOG_WARN("restore result, nothing to restore");
+        notifier_(SUCCESS);
+        return;
+    }
+    if (sync_ == nullptr) {
+        LOG_ERROR("restore result, no sync");
+        notifier_(ERR_SYNC_FAIL);
+        return;
+    }
+    {
+        // before the first pull, a single device session finishes right in Sync
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto self = shared_from_this();
+        deadlineTask_ = retryScheduler_.After(timeout_, [self]() { self->Expire(); });
+    }
+    for (auto &sessionId : pending) {
+        Sync(sessionId, 0);
+    }
+}
+
+void RestoreCoordinator::Sync(const std::string &sessionId, uint32_t attempt)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (isExpired_) {
+            return;
+        }
+        syncStatus_[sessionId] = SYNCING;
+    }
+    auto self = shared_from_this();
+    auto onComplete = [self, sessionId, attempt](bool isSuccess) {
+        if (isSuccess) {
+            LOG_INFO("%{public}s pull data success", sessionId.c_str());
+            self->Finish(sessionId, SYNC_SUCCESS);
+            return;
+        }
+        self->Retry(sessionId, attempt);
+    };
+    LOG_INFO("start sync %{public}s, attempt %{public}u", sessionId.c_str(), attempt);
+    uint32_t result = sync_(sessionId, onComplete);
+    if (result == SUCCESS) {
+        return;
+    }
+    if (result == ERR_SINGLE_DEVICE) {
+        // single device, do not retry
+        Finish(sessionId, SYNC_SUCCESS);
+        return;
+    }
+    if (result == ERR_DB_NOT_EXIST) {
+        LOG_WARN("%{public}s deleted while restoring", sessionId.c_str());
+        Finish(sessionId, SYNC_FAIL);
+        return;
+    }
+    Retry(sessionId, attempt);
+}
+
+void RestoreCoordinator::Retry(const std::string &sessionId, uint32_t attempt)
+{
+    if (attempt + 1 >= MAX_RETRY_TIMES) {
+        LOG_ERROR("%{public}s restore failed after %{public}u times", sessionId.c_str(), attempt + 1);
+        Finish(sessionId, SYNC_FAIL);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (isExpired_) {
+            return;
+        }
+        syncStatus_[sessionId] = SYNC_START;
+    }
+    std::chrono::milliseconds backoff = std::min(initialBackoff_ * (1 << attempt), MAX_BACKOFF);
+    auto self = shared_from_this();
+    retryScheduler_.After(backoff, [self, sessionId, attempt]() { self->Sync(sessionId, attempt + 1); });
+}
+
+void RestoreCoordinator::Finish(const std::string &sessionId, SyncStatus status)
+{
+    TaskScheduler::TaskId deadlineTask = TaskScheduler::INVALID_TASK_ID;
+    bool hasFailed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = syncStatus_.find(sessionId);
+        if (isExpired_ || iter == syncStatus_.end() || iter->second == SYNC_SUCCESS || iter->second == SYNC_FAIL) {
+            return;
+        }
+        iter->second = status;
+        hasFailed_ = hasFailed_ || status == SYNC_FAIL;
+        if (--outstanding_ != 0) {
+            return;
+        }
+        hasFailed = hasFailed_;
+        deadlineTask = deadlineTask_;
+        deadlineTask_ = TaskScheduler::INVALID_TASK_ID;
+    }
+    retryScheduler_.Remove(deadlineTask);
+    LOG_WARN("restore result, failed: %{public}d", hasFailed);
+    notifier_(hasFailed ? ERR_SYNC_FAIL : SUCCESS);
+    LOG_WARN("notify end");
+}
+
+void RestoreCoordinator::Expire()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (outstanding_ == 0) {
+            return;
+        }
+        for (auto &item : syncStatus_) {
+            if (item.second != SYNC_SUCCESS) {
+                LOG_ERROR("%{public}s not restored in time", item.first.c_str());
+                item.second = SYNC_FAIL;
+            }
+        }
+        outstanding_ = 0;
+        isExpired_ = true;
+        deadlineTask_ = TaskScheduler::INVALID_TASK_ID;
+    }
+    LOG_ERROR("restore result, timeout after %{public}lld ms", static_cast<long long>(timeout_.count()));
+    notifier_(ERR_TIMEOUT);
+    LOG_WARN("notify end");
+}
+} // namespace OHOS::ObjectStore
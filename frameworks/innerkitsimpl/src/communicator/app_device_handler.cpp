@@ -50,6 +50,11 @@ std::vector<DeviceInfo> AppDeviceHandler::GetDeviceList() const
     return softbusAdapter_->GetDeviceList();
 }
 
+uint32_t AppDeviceHandler::GetMtuSize(const std::string &deviceId) const
+{
+    return softbusAdapter_->GetMtuSize(deviceId);
+}
+
 DeviceInfo AppDeviceHandler::GetLocalDevice()
 {
     return softbusAdapter_->GetLocalDevice();
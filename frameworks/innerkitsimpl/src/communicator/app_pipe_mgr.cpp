@@ -15,9 +15,13 @@
 
 #include "app_pipe_mgr.h"
 
+#include "packet_fragment.h"
+
 namespace OHOS {
 namespace ObjectStore {
-static const int MAX_TRANSFER_SIZE = 1024 * 1024 * 5;
+// packets above the MTU of the device are split into fragments by SoftBusAdapter, the limit is what
+// a receiver can reassemble
+static const int MAX_TRANSFER_SIZE = FragmentAssembler::MAX_MESSAGE_SIZE;
 Status AppPipeMgr::StartWatchDataChange(const AppDataChangeListener *observer, const PipeInfo &pipeInfo)
 {
     LOG_INFO("begin");
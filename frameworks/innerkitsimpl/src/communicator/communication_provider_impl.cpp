@@ -58,6 +58,11 @@ std::vector<DeviceInfo> CommunicationProviderImpl::GetDeviceList() const
     return appDeviceHandler_.GetDeviceList();
 }
 
+uint32_t CommunicationProviderImpl::GetMtuSize(const DeviceId &deviceId) const
+{
+    return appDeviceHandler_.GetMtuSize(deviceId.deviceId);
+}
+
 Status CommunicationProviderImpl::StartWatchDataChange(const AppDataChangeListener *observer, const PipeInfo &pipeInfo)
 {
     return appPipeMgr_.StartWatchDataChange(observer, pipeInfo);
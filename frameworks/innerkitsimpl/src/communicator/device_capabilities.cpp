@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "device_capabilities.h"
+
+#include <mutex>
+
+namespace OHOS {
+namespace ObjectStore {
+void DeviceCapabilityTable::Put(const std::string &udid, const DeviceCapability &capability)
+{
+    if (udid.empty()) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    capabilities_[udid] = capability;
+}
+
+void DeviceCapabilityTable::Remove(const std::string &udid)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    capabilities_.erase(udid);
+}
+
+bool DeviceCapabilityTable::Get(const std::string &udid, DeviceCapability &capability) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto iter = capabilities_.find(udid);
+    if (iter == capabilities_.end()) {
+        return false;
+    }
+    capability = iter->second;
+    return true;
+}
+
+std::vector<std::string> DeviceCapabilityTable::GetDevices() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::string> devices;
+    for (auto &item : capabilities_) {
+        devices.push_back(item.first);
+    }
+    return devices;
+}
+} // namespace ObjectStore
+} // namespace OHOS
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "device_event_dispatcher.h"
+
+#include "logger.h"
+
+namespace OHOS {
+namespace ObjectStore {
+DeviceEventDispatcher::DeviceEventDispatcher(const Handler &handler, std::chrono::milliseconds window)
+    : handler_(handler), window_(window)
+{
+    thread_ = std::thread([this]() { Run(); });
+}
+
+DeviceEventDispatcher::~DeviceEventDispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopped_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void DeviceEventDispatcher::Post(const DeviceInfo &info, DeviceChangeType type)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = pending_.find(info.deviceId);
+        if (iter != pending_.end()) {
+            if (iter->second.last == DeviceChangeType::DEVICE_OFFLINE && type == DeviceChangeType::DEVICE_ONLINE) {
+                iter->second.isReconnect = true;
+            }
+            iter->second.info = info;
+            iter->second.last = type;
+            return;
+        }
+        pending_[info.deviceId] = { info, type, type, false, std::chrono::steady_clock::now() + window_ };
+        order_.push_back(info.deviceId);
+    }
+    cond_.notify_one();
+}
+
+void DeviceEventDispatcher::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cond_.wait(lock, [this]() { return isStopped_ || !order_.empty(); });
+        if (isStopped_) {
+            return;
+        }
+        auto deadline = pending_[order_.front()].deadline;
+        if (cond_.wait_until(lock, deadline, [this]() { return isStopped_; })) {
+            return;
+        }
+        auto iter = pending_.find(order_.front());
+        order_.pop_front();
+        Pending event = iter->second;
+        pending_.erase(iter);
+        if (event.first == DeviceChangeType::DEVICE_ONLINE && event.last == DeviceChangeType::DEVICE_OFFLINE) {
+            // came and went, the device is offline as it was before the window
+            LOG_INFO("drop flap");
+            continue;
+        }
+        lock.unlock();
+        handler_(event.info, event.last, event.last == DeviceChangeType::DEVICE_ONLINE && event.isReconnect);
+        lock.lock();
+    }
+}
+} // namespace ObjectStore
+} // namespace OHOS
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet_fragment.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+namespace OHOS {
+namespace ObjectStore {
+namespace {
+void PutNum(std::vector<uint8_t> &buffer, uint32_t offset, uint32_t value)
+{
+    for (uint32_t i = 0; i < sizeof(uint32_t); i++) {
+        // 8 bit = 1 byte
+        buffer[offset + i] = static_cast<uint8_t>(value >> ((sizeof(uint32_t) - i - 1) * 8));
+    }
+}
+
+uint32_t GetNum(const uint8_t *data, uint32_t offset)
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < sizeof(uint32_t); i++) {
+        value = (value << 8) | data[offset + i];
+    }
+    return value;
+}
+} // namespace
+
+uint32_t PacketFragment::GetFragmentSize(uint32_t mtu)
+{
+    return std::min(FRAGMENT_SIZE, mtu - HEADER_SIZE);
+}
+
+uint32_t PacketFragment::GetCount(uint32_t length, uint32_t fragmentSize)
+{
+    return (length + fragmentSize - 1) / fragmentSize;
+}
+
+void PacketFragment::Encode(const uint8_t *data, uint32_t length, uint32_t fragmentSize, const FragmentHeader &header,
+    std::vector<uint8_t> &buffer)
+{
+    uint32_t offset = header.index * fragmentSize;
+    uint32_t payloadSize = std::min(fragmentSize, length - offset);
+    buffer.resize(HEADER_SIZE + payloadSize);
+    PutNum(buffer, 0, MAGIC);
+    PutNum(buffer, sizeof(uint32_t), header.nonce);
+    PutNum(buffer, 2 * sizeof(uint32_t), header.msgId);
+    PutNum(buffer, 3 * sizeof(uint32_t), header.index);
+    PutNum(buffer, 4 * sizeof(uint32_t), header.count);
+    PutNum(buffer, 5 * sizeof(uint32_t), length);
+    std::copy(data + offset, data + offset + payloadSize, buffer.begin() + HEADER_SIZE);
+}
+
+bool PacketFragment::Decode(const uint8_t *data, uint32_t length, FragmentHeader &header)
+{
+    if (data == nullptr || length <= HEADER_SIZE || GetNum(data, 0) != MAGIC) {
+        return false;
+    }
+    header.nonce = GetNum(data, sizeof(uint32_t));
+    header.msgId = GetNum(data, 2 * sizeof(uint32_t));
+    header.index = GetNum(data, 3 * sizeof(uint32_t));
+    header.count = GetNum(data, 4 * sizeof(uint32_t));
+    header.totalLength = GetNum(data, 5 * sizeof(uint32_t));
+    return header.count > 1 && header.index < header.count && header.totalLength > length - HEADER_SIZE;
+}
+
+FragmentAssembler::FragmentAssembler(std::chrono::milliseconds timeout, size_t maxPendingBytes)
+    : timeout_(timeout), maxPendingBytes_(maxPendingBytes)
+{
+}
+
+bool FragmentAssembler::Accept(const std::string &deviceId, const std::string &pipeId, const uint8_t *data,
+    uint32_t length, const Deliver &deliver)
+{
+    FragmentHeader header;
+    if (!PacketFragment::Decode(data, length, header)) {
+        return false;
+    }
+    const uint8_t *payload = data + PacketFragment::HEADER_SIZE;
+    uint32_t payloadSize = length - PacketFragment::HEADER_SIZE;
+    std::vector<uint8_t> packet;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        DropExpired(now);
+        Key key(deviceId, pipeId, header.nonce, header.msgId);
+        auto iter = pending_.find(key);
+        if (iter == pending_.end()) {
+            if (header.index != 0) {
+                LOG_WARN("fragment %{public}u of unknown packet %{public}u", header.index, header.msgId);
+                return true;
+            }
+            if (header.totalLength > MAX_MESSAGE_SIZE || pendingBytes_ + header.totalLength > maxPendingBytes_) {
+                LOG_ERROR("no room for packet of %{public}u bytes, pending %{public}zu", header.totalLength,
+                    pendingBytes_);
+                return true;
+            }
+            iter = pending_.emplace(key, Pending()).first;
+            iter->second.header = header;
+            iter->second.data.reserve(header.totalLength);
+            pendingBytes_ += header.totalLength;
+        }
+        Pending &pending = iter->second;
+        if (header.index < pending.nextIndex) {
+            // resent after a reconnect, the first copy already arrived
+            return true;
+        }
+        if (header.index > pending.nextIndex || header.count != pending.header.count
+            || pending.data.size() + payloadSize > pending.header.totalLength) {
+            LOG_ERROR("packet %{public}u broken at fragment %{public}u, drop it", header.msgId, header.index);
+            Drop(iter);
+            return true;
+        }
+        pending.data.insert(pending.data.end(), payload, payload + payloadSize);
+        pending.nextIndex++;
+        pending.lastUpdate = now;
+        if (pending.nextIndex < pending.header.count) {
+            return true;
+        }
+        packet.swap(pending.data);
+        Drop(iter);
+    }
+    if (packet.size() != header.totalLength) {
+        LOG_ERROR("packet %{public}u has %{public}zu bytes, expect %{public}u", header.msgId, packet.size(),
+            header.totalLength);
+        return true;
+    }
+    deliver(packet.data(), static_cast<uint32_t>(packet.size()));
+    return true;
+}
+
+void FragmentAssembler::Clear(const std::string &deviceId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = pending_.lower_bound(Key(deviceId, "", 0, 0));
+    while (iter != pending_.end() && std::get<0>(iter->first) == deviceId) {
+        auto current = iter++;
+        Drop(current);
+    }
+}
+
+size_t FragmentAssembler::GetPendingBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pendingBytes_;
+}
+
+void FragmentAssembler::DropExpired(std::chrono::steady_clock::time_point now)
+{
+    auto iter = pending_.begin();
+    while (iter != pending_.end()) {
+        auto current = iter++;
+        if (now - current->second.lastUpdate >= timeout_) {
+            LOG_WARN("packet %{public}u timeout at fragment %{public}u", std::get<3>(current->first),
+                current->second.nextIndex);
+            Drop(current);
+        }
+    }
+}
+
+void FragmentAssembler::Drop(std::map<Key, Pending>::iterator iter)
+{
+    pendingBytes_ -= iter->second.header.totalLength;
+    pending_.erase(iter);
+}
+
+FragmentWindow::FragmentWindow(uint32_t size) : size_(size)
+{
+}
+
+void FragmentWindow::Acquire(const std::string &deviceId)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_.wait(lock, [this, &deviceId] {
+        auto iter = inFlight_.find(deviceId);
+        return iter == inFlight_.end() || iter->second < size_;
+    });
+    inFlight_[deviceId]++;
+}
+
+void FragmentWindow::Release(const std::string &deviceId)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = inFlight_.find(deviceId);
+        if (iter == inFlight_.end()) {
+            return;
+        }
+        if (--iter->second == 0) {
+            inFlight_.erase(iter);
+        }
+    }
+    released_.notify_all();
+}
+
+uint32_t FragmentWindow::GetInFlight(const std::string &deviceId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = inFlight_.find(deviceId);
+    return iter == inFlight_.end() ? 0 : iter->second;
+}
+} // namespace ObjectStore
+} // namespace OHOS
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "peer_send_queue.h"
+
+#include "logger.h"
+
+namespace OHOS {
+namespace ObjectStore {
+PeerSendQueue::PeerSendQueue(
+    const Sender &sender, size_t maxSize, size_t maxBytes, std::chrono::milliseconds idleTimeout)
+    : sender_(sender), maxSize_(maxSize), maxBytes_(maxBytes), idleTimeout_(idleTimeout)
+{
+}
+
+PeerSendQueue::~PeerSendQueue()
+{
+    // joins the workers before the queues they drain go away, outside the lock a drain takes after each packet
+    std::vector<std::unique_ptr<TaskScheduler>> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &item : queues_) {
+            item.second.packets.clear();
+            workers.push_back(std::move(item.second.worker));
+        }
+    }
+    workers.clear();
+}
+
+PeerSendQueue::PushStatus PeerSendQueue::Push(const std::string &peer, const uint8_t *data, uint32_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = queues_.find(peer);
+    if (iter == queues_.end()) {
+        iter = queues_.emplace(peer, PeerQueue()).first;
+        iter->second.generation = ++lastGeneration_;
+    }
+    PeerQueue &queue = iter->second;
+    // the peer came back while its last packet was still being sent, the worker stays
+    queue.isRemoved = false;
+    if (queue.isBroken) {
+        queue.isBroken = false;
+        return PEER_BROKEN;
+    }
+    bool isEmpty = queue.packets.empty();
+    if (!isEmpty && (queue.packets.size() >= maxSize_ || queue.bytes + length > maxBytes_)) {
+        LOG_WARN("send queue full, depth:%{public}zu, bytes:%{public}zu", queue.packets.size(), queue.bytes);
+        return QUEUE_FULL;
+    }
+    queue.packets.emplace_back(data, data + length);
+    queue.bytes += length;
+    if (!queue.isSending && queue.worker != nullptr) {
+        queue.isSending = true;
+        queue.worker->Execute([this, peer]() { Drain(peer); });
+    }
+    return QUEUED;
+}
+
+void PeerSendQueue::Drain(const std::string &peer)
+{
+    // a removed queue is destroyed on its own worker once this returns, the worker ends after it
+    std::unique_ptr<TaskScheduler> removed;
+    while (true) {
+        std::vector<uint8_t> packet;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto iter = queues_.find(peer);
+            if (iter == queues_.end()) {
+                return;
+            }
+            PeerQueue &queue = iter->second;
+            if (queue.packets.empty()) {
+                removed = StopSending(iter);
+                return;
+            }
+            packet = std::move(queue.packets.front());
+            queue.packets.pop_front();
+            queue.bytes -= packet.size();
+        }
+        if (sender_(peer, packet)) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = queues_.find(peer);
+        if (iter == queues_.end()) {
+            return;
+        }
+        PeerQueue &queue = iter->second;
+        LOG_ERROR("send %{public}zu bytes failed, drop %{public}zu packets behind it", packet.size(),
+            queue.packets.size());
+        queue.packets.clear();
+        queue.bytes = 0;
+        queue.isBroken = true;
+        removed = StopSending(iter);
+        return;
+    }
+}
+
+std::unique_ptr<TaskScheduler> PeerSendQueue::StopSending(std::map<std::string, PeerQueue>::iterator iter)
+{
+    PeerQueue &queue = iter->second;
+    queue.isSending = false;
+    if (queue.isRemoved) {
+        return Erase(iter);
+    }
+    queue.lastActive = std::chrono::steady_clock::now();
+    // taken by the destructor already
+    if (queue.worker == nullptr) {
+        return nullptr;
+    }
+    queue.worker->After(idleTimeout_, [this, peer = iter->first, generation = queue.generation]() {
+        RemoveIfIdle(peer, generation);
+    });
+    return nullptr;
+}
+
+void PeerSendQueue::RemoveIfIdle(const std::string &peer, uint64_t generation)
+{
+    // destroyed by its own worker outside the lock, the worker ends once this returns
+    std::unique_ptr<TaskScheduler> worker;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = queues_.find(peer);
+    if (iter == queues_.end() || iter->second.generation != generation || iter->second.isSending
+        || std::chrono::steady_clock::now() - iter->second.lastActive < idleTimeout_) {
+        return;
+    }
+    LOG_INFO("send queue idle for %{public}lld ms, remove it", static_cast<long long>(idleTimeout_.count()));
+    worker = Erase(iter);
+}
+
+void PeerSendQueue::Remove(const std::string &peer)
+{
+    std::unique_ptr<TaskScheduler> worker;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = queues_.find(peer);
+        if (iter == queues_.end()) {
+            return;
+        }
+        PeerQueue &queue = iter->second;
+        LOG_INFO("remove send queue, drop %{public}zu packets not sent", queue.packets.size());
+        if (queue.isSending) {
+            queue.packets.clear();
+            queue.bytes = 0;
+            queue.isBroken = false;
+            queue.isRemoved = true;
+            return;
+        }
+        worker = Erase(iter);
+    }
+    // joined outside the lock, an idle check running on it takes the lock
+    worker = nullptr;
+}
+
+std::unique_ptr<TaskScheduler> PeerSendQueue::Erase(std::map<std::string, PeerQueue>::iterator iter)
+{
+    std::unique_ptr<TaskScheduler> worker = std::move(iter->second.worker);
+    queues_.erase(iter);
+    return worker;
+}
+
+size_t PeerSendQueue::GetDepth(const std::string &peer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = queues_.find(peer);
+    return iter == queues_.end() ? 0 : iter->second.packets.size();
+}
+
+size_t PeerSendQueue::GetPeerCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queues_.size();
+}
+} // namespace ObjectStore
+} // namespace OHOS
@@ -21,6 +21,17 @@ namespace OHOS {
 namespace ObjectStore {
 using namespace DistributedDB;
 ProcessCommunicatorImpl::ProcessCommunicatorImpl()
+    : sendQueue_([this](const std::string &peer, const std::vector<uint8_t> &data) {
+          PipeInfo pi = { thisProcessLabel_ };
+          DeviceId destination = { peer };
+          Status errCode = CommunicationProvider::GetInstance().SendData(
+              pi, destination, data.data(), static_cast<int>(data.size()));
+          if (errCode != Status::SUCCESS) {
+              LOG_ERROR("commProvider_ SendData Fail.");
+              return false;
+          }
+          return true;
+      })
 {
 }
 
@@ -80,10 +91,10 @@ DBStatus ProcessCommunicatorImpl::RegOnDeviceChange(const OnDeviceChange &callba
 
 DBStatus ProcessCommunicatorImpl::RegOnDataReceive(const OnDataReceive &callback)
 {
-    {
-        std::lock_guard<std::mutex> onDataReceiveLockGard(onDataReceiveMutex_);
-        onDataReceiveHandler_ = callback;
-    }
+    std::atomic_store(&onDataReceiveHandler_,
+        callback ? std::make_shared<const OnDataReceive>(callback) : std::shared_ptr<const OnDataReceive>());
+    // the replaced handler may belong to an object going away once this returns
+    handlerGate_.Synchronize();
 
     PipeInfo pi = { thisProcessLabel_ };
     if (callback) {
@@ -104,35 +115,34 @@ DBStatus ProcessCommunicatorImpl::RegOnDataReceive(const OnDataReceive &callback
 
 DBStatus ProcessCommunicatorImpl::SendData(const DeviceInfos &dstDevInfo, const uint8_t *data, uint32_t length)
 {
-    PipeInfo pi = { thisProcessLabel_ };
-    DeviceId destination;
-    destination.deviceId = dstDevInfo.identifier;
-    Status errCode = CommunicationProvider::GetInstance().SendData(pi, destination, data, static_cast<int>(length));
-    if (errCode != Status::SUCCESS) {
-        LOG_ERROR("commProvider_ SendData Fail.");
+    if (data == nullptr || length == 0 || dstDevInfo.identifier.empty()) {
+        LOG_ERROR("invalid packet, length:%{public}u", length);
+        return DBStatus::DB_ERROR;
+    }
+    PeerSendQueue::PushStatus status = sendQueue_.Push(dstDevInfo.identifier, data, length);
+    if (status == PeerSendQueue::QUEUE_FULL) {
+        return DBStatus::RATE_LIMIT;
+    }
+    if (status == PeerSendQueue::PEER_BROKEN) {
+        LOG_ERROR("an earlier packet to the peer failed");
         return DBStatus::DB_ERROR;
     }
-
     return DBStatus::OK;
 }
 
+size_t ProcessCommunicatorImpl::GetSendQueueDepth(const std::string &deviceId)
+{
+    return sendQueue_.GetDepth(deviceId);
+}
+
 uint32_t ProcessCommunicatorImpl::GetMtuSize()
 {
-    return MTU_SIZE;
+    return DeviceCapabilityTable::DEFAULT_MTU;
 }
 
 uint32_t ProcessCommunicatorImpl::GetMtuSize(const DeviceInfos &devInfo)
 {
-    LOG_INFO("GetMtuSize start");
-    std::vector<DeviceInfo> devInfos = CommunicationProvider::GetInstance().GetDeviceList();
-    for (auto const &entry : devInfos) {
-        LOG_INFO("GetMtuSize deviceType: %{public}s", entry.deviceType.c_str());
-        bool isWatch = (entry.deviceType == SMART_WATCH_TYPE || entry.deviceType == CHILDREN_WATCH_TYPE);
-        if (entry.deviceId == devInfo.identifier && isWatch) {
-            return MTU_SIZE_WATCH;
-        }
-    }
-    return MTU_SIZE;
+    return CommunicationProvider::GetInstance().GetMtuSize({ devInfo.identifier });
 }
 
 DeviceInfos ProcessCommunicatorImpl::GetLocalDeviceInfos()
@@ -165,14 +175,15 @@ bool ProcessCommunicatorImpl::IsSameProcessLabelStartedOnPeerDevice(const Device
 void ProcessCommunicatorImpl::OnMessage(
     const DeviceInfo &info, const uint8_t *ptr, const int size, __attribute__((unused)) const PipeInfo &pipeInfo) const
 {
-    std::lock_guard<std::mutex> onDataReceiveLockGuard(onDataReceiveMutex_);
-    if (onDataReceiveHandler_ == nullptr) {
+    ReaderGate::Reader reader(handlerGate_);
+    auto handler = std::atomic_load(&onDataReceiveHandler_);
+    if (handler == nullptr) {
         LOG_ERROR("onDataReceiveHandler_ invalid.");
         return;
     }
     DeviceInfos devInfo;
     devInfo.identifier = info.deviceId;
-    onDataReceiveHandler_(devInfo, ptr, static_cast<uint32_t>(size));
+    (*handler)(devInfo, ptr, static_cast<uint32_t>(size));
 }
 
 void ProcessCommunicatorImpl::OnDeviceChanged(const DeviceInfo &info, const DeviceChangeType &type) const
@@ -182,6 +193,9 @@ void ProcessCommunicatorImpl::OnDeviceChanged(const DeviceInfo &info, const Devi
         LOG_ERROR("onDeviceChangeHandler_ invalid.");
         return;
     }
+    if (type == DeviceChangeType::DEVICE_OFFLINE) {
+        sendQueue_.Remove(info.deviceId);
+    }
     DeviceInfos devInfo;
     devInfo.identifier = info.deviceId;
     onDeviceChangeHandler_(devInfo, (type == DeviceChangeType::DEVICE_ONLINE));
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "receive_worker_pool.h"
+
+#include "logger.h"
+
+namespace OHOS {
+namespace ObjectStore {
+ReceiveWorkerPool::ReceiveWorkerPool(size_t workers, size_t maxPeerBytes) : maxPeerBytes_(maxPeerBytes)
+{
+    workers = workers == 0 ? 1 : workers;
+    for (size_t i = 0; i < workers; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (auto &worker : workers_) {
+        Worker *current = worker.get();
+        worker->thread = std::thread([current]() { Run(*current); });
+    }
+}
+
+ReceiveWorkerPool::~ReceiveWorkerPool()
+{
+    for (auto &worker : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->isStopped = true;
+        }
+        worker->cond.notify_all();
+    }
+    for (auto &worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool ReceiveWorkerPool::Post(const std::string &peer, size_t bytes, Task task)
+{
+    Worker &worker = GetWorker(peer);
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.isStopped) {
+            return false;
+        }
+        Peer &state = worker.peers[peer];
+        if (bytes != 0 && state.bytes != 0 && state.bytes + bytes > maxPeerBytes_) {
+            state.dropped++;
+            LOG_WARN("receive queue of peer full, bytes:%{public}zu, dropped:%{public}llu", state.bytes,
+                static_cast<unsigned long long>(state.dropped));
+            return false;
+        }
+        state.bytes += bytes;
+        worker.tasks.push_back({ peer, bytes, std::move(task) });
+    }
+    worker.cond.notify_all();
+    return true;
+}
+
+size_t ReceiveWorkerPool::GetWorkerCount() const
+{
+    return workers_.size();
+}
+
+uint64_t ReceiveWorkerPool::GetDropped(const std::string &peer)
+{
+    Worker &worker = GetWorker(peer);
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    auto iter = worker.peers.find(peer);
+    return iter == worker.peers.end() ? 0 : iter->second.dropped;
+}
+
+ReceiveWorkerPool::Worker &ReceiveWorkerPool::GetWorker(const std::string &peer)
+{
+    return *workers_[std::hash<std::string>{}(peer) % workers_.size()];
+}
+
+void ReceiveWorkerPool::Run(Worker &worker)
+{
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    while (true) {
+        worker.cond.wait(lock, [&worker]() { return worker.isStopped || !worker.tasks.empty(); });
+        if (worker.isStopped) {
+            return;
+        }
+        Item item = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+        lock.unlock();
+        item.task();
+        lock.lock();
+        // bytes of a task are held until it is done
+        auto iter = worker.peers.find(item.peer);
+        if (iter == worker.peers.end()) {
+            continue;
+        }
+        iter->second.bytes -= item.bytes;
+        if (iter->second.bytes == 0 && iter->second.dropped == 0) {
+            worker.peers.erase(iter);
+        }
+    }
+}
+} // namespace ObjectStore
+} // namespace OHOS
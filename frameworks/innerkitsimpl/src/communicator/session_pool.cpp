@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "session_pool.h"
+
+#include "logger.h"
+
+namespace OHOS {
+namespace ObjectStore {
+SessionPool::SessionPool(
+    const Opener &opener, const Closer &closer, std::chrono::milliseconds idleTimeout, uint32_t maxOpening)
+    : opener_(opener), closer_(closer), idleTimeout_(idleTimeout), maxOpening_(maxOpening)
+{
+}
+
+SessionPool::~SessionPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reaper_.Remove(reapTask_);
+        reapTask_ = TaskScheduler::INVALID_TASK_ID;
+    }
+    Clear();
+}
+
+int32_t SessionPool::Acquire(const std::string &pipeId, const std::string &peer)
+{
+    std::string key = GetKey(pipeId, peer);
+    auto deadline = std::chrono::steady_clock::now() + ACQUIRE_TIMEOUT;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        auto iter = entries_.find(key);
+        if (iter != entries_.end() && iter->second.sessionId != INVALID_SESSION) {
+            iter->second.lastUsed = std::chrono::steady_clock::now();
+            return iter->second.sessionId;
+        }
+        bool isOpening = iter != entries_.end() && iter->second.isOpening;
+        if (!isOpening && opening_ < maxOpening_) {
+            break;
+        }
+        // somebody opens this session already, or too many sessions are being opened
+        if (openDone_.wait_until(lock, deadline) == std::cv_status::timeout) {
+            LOG_WARN("wait session of %{public}s timeout", pipeId.c_str());
+            return INVALID_SESSION;
+        }
+    }
+    entries_[key].isOpening = true;
+    opening_++;
+    auto token = openToken_;
+    lock.unlock();
+    int32_t sessionId = opener_(pipeId, peer, token);
+    lock.lock();
+    opening_--;
+    Entry &entry = entries_[key];
+    entry.isOpening = false;
+    if (sessionId < 0) {
+        entries_.erase(key);
+    } else {
+        entry.sessionId = sessionId;
+        entry.failures = 0;
+        entry.lastUsed = std::chrono::steady_clock::now();
+    }
+    openDone_.notify_all();
+    if (sessionId >= 0 && reapTask_ == TaskScheduler::INVALID_TASK_ID) {
+        ScheduleReap();
+    }
+    return sessionId < 0 ? INVALID_SESSION : sessionId;
+}
+
+void SessionPool::Release(const std::string &pipeId, const std::string &peer, int32_t sessionId, bool isSuccess)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = entries_.find(GetKey(pipeId, peer));
+        if (iter == entries_.end() || iter->second.sessionId != sessionId) {
+            return;
+        }
+        if (isSuccess) {
+            iter->second.failures = 0;
+            return;
+        }
+        if (++iter->second.failures < MAX_FAILURES) {
+            return;
+        }
+        LOG_WARN("session %{public}d failed %{public}u times, close it", sessionId, iter->second.failures);
+        entries_.erase(iter);
+    }
+    closer_(sessionId);
+}
+
+void SessionPool::OnClosed(int32_t sessionId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto iter = entries_.begin(); iter != entries_.end(); iter++) {
+        if (iter->second.sessionId == sessionId) {
+            entries_.erase(iter);
+            return;
+        }
+    }
+}
+
+void SessionPool::CloseIdle()
+{
+    std::vector<int32_t> idleSessions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        auto iter = entries_.begin();
+        while (iter != entries_.end()) {
+            if (iter->second.sessionId != INVALID_SESSION && now - iter->second.lastUsed >= idleTimeout_) {
+                idleSessions.push_back(iter->second.sessionId);
+                iter = entries_.erase(iter);
+            } else {
+                iter++;
+            }
+        }
+    }
+    if (!idleSessions.empty()) {
+        LOG_INFO("close %{public}zu idle sessions", idleSessions.size());
+    }
+    CloseAll(idleSessions);
+}
+
+void SessionPool::Clear()
+{
+    std::vector<int32_t> sessionIds;
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        openToken_.swap(token);
+        auto iter = entries_.begin();
+        while (iter != entries_.end()) {
+            if (iter->second.isOpening) {
+                iter++;
+                continue;
+            }
+            sessionIds.push_back(iter->second.sessionId);
+            iter = entries_.erase(iter);
+        }
+    }
+    token->Cancel();
+    CloseAll(sessionIds);
+}
+
+size_t SessionPool::Size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t size = 0;
+    for (auto &item : entries_) {
+        if (item.second.sessionId != INVALID_SESSION) {
+            size++;
+        }
+    }
+    return size;
+}
+
+std::string SessionPool::GetKey(const std::string &pipeId, const std::string &peer)
+{
+    return pipeId + "#" + peer;
+}
+
+void SessionPool::ScheduleReap()
+{
+    reapTask_ = reaper_.After(idleTimeout_ / 2, [this]() { Reap(); });
+}
+
+void SessionPool::Reap()
+{
+    CloseIdle();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (reapTask_ == TaskScheduler::INVALID_TASK_ID) {
+        // cancelled by the destructor while closing
+        return;
+    }
+    if (entries_.empty()) {
+        reapTask_ = TaskScheduler::INVALID_TASK_ID;
+        return;
+    }
+    ScheduleReap();
+}
+
+void SessionPool::CloseAll(const std::vector<int32_t> &sessionIds)
+{
+    for (auto sessionId : sessionIds) {
+        closer_(sessionId);
+    }
+}
+} // namespace ObjectStore
+} // namespace OHOS
@@ -15,7 +15,11 @@
 
 #include <logger.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
 #include <mutex>
+#include <random>
 #include <thread>
 
 #include "kv_store_delegate_manager.h"
@@ -24,6 +28,7 @@
 #include "session.h"
 #include "softbus_adapter.h"
 #include "softbus_bus_center.h"
+#include "wait_statistics.h"
 
 namespace OHOS {
 namespace ObjectStore {
@@ -38,6 +43,11 @@ constexpr int32_t INVALID_SESSION_ID = -1;
 constexpr int32_t SESSION_NAME_SIZE_MAX = 65;
 constexpr int32_t DEVICE_ID_SIZE_MAX = 65;
 constexpr int32_t ID_BUF_LEN = 65;
+// deviceTypeIds SoftBus reports for devices on a constrained link, the SoftBus constants are not in its public headers
+constexpr uint32_t WIFI_CAMERA_TYPE_ID = 0x08;
+constexpr uint32_t AUDIO_TYPE_ID = 0x0A;
+constexpr uint32_t SMART_WATCH_TYPE_ID = 0x6D;
+constexpr uint32_t LOW_CAPABILITY_TYPE_IDS[] = { WIFI_CAMERA_TYPE_ID, AUDIO_TYPE_ID, SMART_WATCH_TYPE_ID };
 using namespace std;
 
 class AppDeviceListenerWrap {
@@ -67,10 +77,6 @@ public:
     static void OnMessageReceived(int sessionId, const void *data, unsigned int dataLen);
     static void OnBytesReceived(int sessionId, const void *data, unsigned int dataLen);
 
-public:
-    // notifiy all listeners when received message
-    static void NotifyDataListeners(
-        const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo);
     static SoftBusAdapter *softBusAdapter_;
 };
 SoftBusAdapter *AppDataListenerWrap::softBusAdapter_;
@@ -111,7 +117,7 @@ void AppDeviceListenerWrap::NotifyAll(NodeBasicInfo *info, DeviceChangeType type
     softBusAdapter_->NotifyAll(di, type);
 }
 
-SoftBusAdapter::SoftBusAdapter()
+SoftBusAdapter::SoftBusAdapter() : msgNonce_(std::random_device()())
 {
     LOG_INFO("begin");
     AppDeviceListenerWrap::SetDeviceHandler(this);
@@ -126,11 +132,27 @@ SoftBusAdapter::SoftBusAdapter()
     sessionListener_.OnSessionClosed = AppDataListenerWrap::OnSessionClosed;
     sessionListener_.OnBytesReceived = AppDataListenerWrap::OnBytesReceived;
     sessionListener_.OnMessageReceived = AppDataListenerWrap::OnMessageReceived;
+
+    receivePool_ = std::make_unique<ReceiveWorkerPool>();
+    deviceEvents_ = std::make_unique<DeviceEventDispatcher>(
+        [this](const DeviceInfo &deviceInfo, DeviceChangeType type, bool isReconnect) {
+            DispatchDeviceChange(deviceInfo, type, isReconnect);
+        },
+        DEVICE_EVENT_WINDOW);
+    sessionPool_ = std::make_shared<SessionPool>(
+        [this](const std::string &pipeId, const std::string &networkId,
+            const std::shared_ptr<CancellationToken> &token) { return OpenSessionSync(pipeId, networkId, token); },
+        [this](int32_t sessionId) {
+            CloseSession(sessionId);
+            ClearSessionStatus(sessionId);
+            ClearSessionPeer(sessionId);
+        });
 }
 
 SoftBusAdapter::~SoftBusAdapter()
 {
     LOG_INFO("begin");
+    sessionPool_->Clear();
     int32_t errNo = UnregNodeDeviceStateCb(&nodeStateCb_);
     if (errNo != SOFTBUS_OK) {
         LOG_ERROR("UnregNodeDeviceStateCb fail %{public}d", errNo);
@@ -151,6 +173,8 @@ void SoftBusAdapter::Init()
                 continue;
             }
             LOG_INFO("RegNodeDeviceStateCb success");
+            // devices already online before the callback was registered are not reported
+            LoadDirectory();
             return;
         }
         LOG_ERROR("Init failed %{public}d times and exit now.", RETRY_TIMES);
@@ -195,51 +219,67 @@ Status SoftBusAdapter::StopWatchDeviceChange(
 
 void SoftBusAdapter::NotifyAll(const DeviceInfo &deviceInfo, const DeviceChangeType &type)
 {
-    std::thread th = std::thread([this, deviceInfo, type]() {
-        std::vector<const AppDeviceStatusChangeListener *> listeners;
-        {
-            std::lock_guard<std::mutex> lock(deviceChangeMutex_);
-            for (const auto &listener : listeners_) {
-                listeners.push_back(listener);
-            }
+    // resolved before the directory forgets an offline device
+    std::string udid = GetUdidByNodeId(deviceInfo.deviceId);
+    LOG_DEBUG("[Notify] to DB from: %{public}s, type:%{public}d", ToBeAnonymous(udid).c_str(), type);
+    UpdateRelationship(deviceInfo.deviceId, type);
+    if (type == DeviceChangeType::DEVICE_ONLINE) {
+        capabilities_.Put(udid, MakeCapability(std::strtoul(deviceInfo.deviceType.c_str(), nullptr, 10)));
+    } else {
+        capabilities_.Remove(udid);
+        // after the fragments already posted from the device
+        receivePool_->Post(udid, 0, [this, udid]() { assembler_.Clear(udid); });
+    }
+    deviceEvents_->Post({ udid, deviceInfo.deviceName, deviceInfo.deviceType }, type);
+}
+
+void SoftBusAdapter::DispatchDeviceChange(const DeviceInfo &deviceInfo, DeviceChangeType type, bool isReconnect)
+{
+    std::vector<const AppDeviceStatusChangeListener *> listeners;
+    {
+        std::lock_guard<std::mutex> lock(deviceChangeMutex_);
+        for (const auto &listener : listeners_) {
+            listeners.push_back(listener);
         }
-        LOG_DEBUG("high");
-        std::string udid = GetUdidByNodeId(deviceInfo.deviceId);
-        LOG_DEBUG("[Notify] to DB from: %{public}s, type:%{public}d", ToBeAnonymous(udid).c_str(), type);
-        UpdateRelationship(deviceInfo.deviceId, type);
-        for (const auto &device : listeners) {
-            if (device == nullptr) {
-                continue;
-            }
-            if (device->GetChangeLevelType() == ChangeLevelType::HIGH) {
-                DeviceInfo di = { udid, deviceInfo.deviceName, deviceInfo.deviceType };
-                device->OnDeviceChanged(di, type);
-                break;
-            }
+    }
+    LOG_DEBUG("high");
+    for (const auto &device : listeners) {
+        if (device == nullptr) {
+            continue;
         }
-        LOG_DEBUG("low");
-        for (const auto &device : listeners) {
-            if (device == nullptr) {
-                continue;
-            }
-            if (device->GetChangeLevelType() == ChangeLevelType::LOW) {
-                DeviceInfo di = { udid, deviceInfo.deviceName, deviceInfo.deviceType };
-                device->OnDeviceChanged(di, DeviceChangeType::DEVICE_OFFLINE);
-                device->OnDeviceChanged(di, type);
+        if (device->GetChangeLevelType() == ChangeLevelType::HIGH) {
+            if (isReconnect) {
+                device->OnDeviceChanged(deviceInfo, DeviceChangeType::DEVICE_OFFLINE);
             }
+            device->OnDeviceChanged(deviceInfo, type);
+            break;
         }
-        LOG_DEBUG("min");
-        for (const auto &device : listeners) {
-            if (device == nullptr) {
-                continue;
+    }
+    LOG_DEBUG("low");
+    for (const auto &device : listeners) {
+        if (device == nullptr) {
+            continue;
+        }
+        if (device->GetChangeLevelType() == ChangeLevelType::LOW) {
+            // a device coming back may have gone away without an offline event, reset its state first
+            if (type == DeviceChangeType::DEVICE_ONLINE) {
+                device->OnDeviceChanged(deviceInfo, DeviceChangeType::DEVICE_OFFLINE);
             }
-            if (device->GetChangeLevelType() == ChangeLevelType::MIN) {
-                DeviceInfo di = { udid, deviceInfo.deviceName, deviceInfo.deviceType };
-                device->OnDeviceChanged(di, type);
+            device->OnDeviceChanged(deviceInfo, type);
+        }
+    }
+    LOG_DEBUG("min");
+    for (const auto &device : listeners) {
+        if (device == nullptr) {
+            continue;
+        }
+        if (device->GetChangeLevelType() == ChangeLevelType::MIN) {
+            if (isReconnect) {
+                device->OnDeviceChanged(deviceInfo, DeviceChangeType::DEVICE_OFFLINE);
             }
+            device->OnDeviceChanged(deviceInfo, type);
         }
-    });
-    th.detach();
+    }
 }
 
 std::vector<DeviceInfo> SoftBusAdapter::GetDeviceList() const
@@ -267,6 +307,41 @@ std::vector<DeviceInfo> SoftBusAdapter::GetDeviceList() const
     return dis;
 }
 
+std::vector<std::string> SoftBusAdapter::GetOnlineDevices() const
+{
+    std::vector<std::string> devices = capabilities_.GetDevices();
+    if (!devices.empty()) {
+        return devices;
+    }
+    // the table is filled by device events and the directory load of Init, SoftBus is asked until then
+    for (auto &device : GetDeviceList()) {
+        if (!device.deviceId.empty()) {
+            devices.push_back(device.deviceId);
+        }
+    }
+    return devices;
+}
+
+uint32_t SoftBusAdapter::GetMtuSize(const std::string &deviceId) const
+{
+    DeviceCapability capability;
+    if (!capabilities_.Get(deviceId, capability)) {
+        return DeviceCapabilityTable::DEFAULT_MTU;
+    }
+    return capability.mtu;
+}
+
+DeviceCapability SoftBusAdapter::MakeCapability(uint32_t deviceTypeId)
+{
+    DeviceCapability capability;
+    capability.deviceTypeId = deviceTypeId;
+    bool isLowCapability = std::find(std::begin(LOW_CAPABILITY_TYPE_IDS), std::end(LOW_CAPABILITY_TYPE_IDS),
+        deviceTypeId) != std::end(LOW_CAPABILITY_TYPE_IDS);
+    capability.mtu = isLowCapability ? DeviceCapabilityTable::LOW_CAPABILITY_MTU : DeviceCapabilityTable::DEFAULT_MTU;
+    capability.fragmentSize = PacketFragment::GetFragmentSize(capability.mtu);
+    return capability;
+}
+
 DeviceInfo SoftBusAdapter::GetLocalDevice()
 {
     if (!localInfo_.deviceId.empty()) {
@@ -287,6 +362,17 @@ DeviceInfo SoftBusAdapter::GetLocalDevice()
 }
 
 std::string SoftBusAdapter::GetUdidByNodeId(const std::string &nodeId) const
+{
+    std::string udid = directory_.GetUdid(nodeId);
+    if (!udid.empty()) {
+        return udid;
+    }
+    udid = QueryUdid(nodeId);
+    directory_.Put(nodeId, udid);
+    return udid;
+}
+
+std::string SoftBusAdapter::QueryUdid(const std::string &nodeId) const
 {
     char udid[ID_BUF_LEN] = { 0 };
     int32_t ret = GetNodeKeyInfo("ohos.objectstore", nodeId.c_str(), NodeDeviceInfoKey::NODE_KEY_UDID,
@@ -342,20 +428,15 @@ std::vector<DeviceInfo> SoftBusAdapter::GetRemoteNodesBasicInfo() const
 
 void SoftBusAdapter::UpdateRelationship(const std::string &networkid, const DeviceChangeType &type)
 {
-    auto udid = GetUdidByNodeId(networkid);
-    lock_guard<mutex> lock(networkMutex_);
     switch (type) {
         case DeviceChangeType::DEVICE_OFFLINE: {
-            auto size = this->networkId2Udid_.erase(networkid);
-            if (size == 0) {
-                LOG_WARN("not found id:%{public}s.", networkid.c_str());
+            if (!directory_.Remove(networkid)) {
+                LOG_WARN("not found id:%{public}s.", ToBeAnonymous(networkid).c_str());
             }
             break;
         }
         case DeviceChangeType::DEVICE_ONLINE: {
-            std::pair<std::string, std::string> value = { networkid, udid };
-            auto res = this->networkId2Udid_.insert(std::move(value));
-            if (!res.second) {
+            if (GetUdidByNodeId(networkid).empty()) {
                 LOG_WARN("insert failed.");
             }
             break;
@@ -366,40 +447,37 @@ void SoftBusAdapter::UpdateRelationship(const std::string &networkid, const Devi
         }
     }
 }
+
 std::string SoftBusAdapter::ToNodeID(const std::string &nodeId) const
 {
-    {
-        lock_guard<mutex> lock(networkMutex_);
-        for (auto const &e : networkId2Udid_) {
-            if (nodeId == e.second) { // id is udid
-                return e.first;
-            }
-        }
+    std::string networkId = directory_.GetNetworkId(nodeId);
+    if (!networkId.empty()) {
+        return networkId;
     }
-
     LOG_WARN("get the network id from devices.");
-    std::vector<DeviceInfo> devices;
+    LoadDirectory();
+    return directory_.GetNetworkId(nodeId);
+}
+
+void SoftBusAdapter::LoadDirectory() const
+{
     NodeBasicInfo *info = nullptr;
     int32_t infoNum = 0;
-    std::string networkId;
     int32_t ret = GetAllNodeDeviceInfo("ohos.objectstore", &info, &infoNum);
-    if (ret == SOFTBUS_OK) {
-        lock_guard<mutex> lock(networkMutex_);
-        for (int i = 0; i < infoNum; i++) {
-            if (networkId2Udid_.find(info[i].networkId) != networkId2Udid_.end()) {
-                continue;
-            }
-            auto udid = GetUdidByNodeId(std::string(info[i].networkId));
-            networkId2Udid_.insert({ info[i].networkId, udid });
-            if (udid == nodeId) {
-                networkId = info[i].networkId;
-            }
+    if (ret != SOFTBUS_OK) {
+        LOG_ERROR("GetAllNodeDeviceInfo error");
+        return;
+    }
+    for (int i = 0; i < infoNum; i++) {
+        std::string udid = GetUdidByNodeId(std::string(info[i].networkId));
+        DeviceCapability capability;
+        if (!capabilities_.Get(udid, capability)) {
+            capabilities_.Put(udid, MakeCapability(info[i].deviceTypeId));
         }
     }
     if (info != nullptr) {
         FreeNodeInfo(info);
     }
-    return networkId;
 }
 
 std::string SoftBusAdapter::ToBeAnonymous(const std::string &name)
@@ -429,13 +507,13 @@ Status SoftBusAdapter::StartWatchDataChange(const AppDataChangeListener *observe
         return Status::INVALID_ARGUMENT;
     }
     lock_guard<mutex> lock(dataChangeMutex_);
-    auto it = dataChangeListeners_.find(pipeInfo.pipeId);
-    if (it != dataChangeListeners_.end()) {
+    auto listeners = std::make_shared<DataListeners>(*dataChangeListeners_);
+    if (!listeners->insert({ pipeInfo.pipeId, observer }).second) {
         LOG_WARN("Add listener error or repeated adding.");
         return Status::ERROR;
     }
     LOG_DEBUG("current appid %{public}s", pipeInfo.pipeId.c_str());
-    dataChangeListeners_.insert({ pipeInfo.pipeId, observer });
+    std::atomic_store(&dataChangeListeners_, std::shared_ptr<const DataListeners>(std::move(listeners)));
     return Status::SUCCESS;
 }
 
@@ -443,38 +521,83 @@ Status SoftBusAdapter::StopWatchDataChange(
     __attribute__((unused)) const AppDataChangeListener *observer, const PipeInfo &pipeInfo)
 {
     LOG_DEBUG("begin");
-    lock_guard<mutex> lock(dataChangeMutex_);
-    if (dataChangeListeners_.erase(pipeInfo.pipeId)) {
-        return Status::SUCCESS;
+    {
+        lock_guard<mutex> lock(dataChangeMutex_);
+        auto listeners = std::make_shared<DataListeners>(*dataChangeListeners_);
+        if (!listeners->erase(pipeInfo.pipeId)) {
+            LOG_WARN("stop data observer error, pipeInfo:%{public}s", pipeInfo.pipeId.c_str());
+            return Status::ERROR;
+        }
+        std::atomic_store(&dataChangeListeners_, std::shared_ptr<const DataListeners>(std::move(listeners)));
     }
-    LOG_WARN("stop data observer error, pipeInfo:%{public}s", pipeInfo.pipeId.c_str());
-    return Status::ERROR;
+    // outside the lock, a listener being called may start or stop watching itself
+    listenerGate_.Synchronize();
+    return Status::SUCCESS;
 }
 
 Status SoftBusAdapter::SendData(
     const PipeInfo &pipeInfo, const DeviceId &deviceId, const uint8_t *ptr, int size, const MessageInfo &info)
 {
-    SessionAttribute attr;
-    attr.dataType = TYPE_BYTES;
     LOG_INFO("[SendData] to %{public}s ,session:%{public}s, size:%{public}d",
         ToBeAnonymous(deviceId.deviceId).c_str(), pipeInfo.pipeId.c_str(), size);
-    int sessionId = OpenSession(
-        pipeInfo.pipeId.c_str(), pipeInfo.pipeId.c_str(), ToNodeID(deviceId.deviceId).c_str(), "GROUP_ID", &attr);
-    if (sessionId < 0) {
-        LOG_WARN("OpenSession %{public}s, type:%{public}d failed, sessionId:%{public}d", pipeInfo.pipeId.c_str(),
-            info.msgType, sessionId);
-        return Status::CREATE_SESSION_ERROR;
+    std::string networkId = ToNodeID(deviceId.deviceId);
+    // the default link unless the device is known
+    DeviceCapability capability = MakeCapability(0);
+    capabilities_.Get(deviceId.deviceId, capability);
+    if (static_cast<uint32_t>(size) > capability.mtu) {
+        return SendFragments(pipeInfo, networkId, ptr, size, capability.fragmentSize);
+    }
+    Status status = SendBytesOnce(pipeInfo, networkId, ptr, size);
+    if (status == Status::CREATE_SESSION_ERROR) {
+        LOG_WARN("OpenSession %{public}s, type:%{public}d failed", pipeInfo.pipeId.c_str(), info.msgType);
+    }
+    return status;
+}
+
+Status SoftBusAdapter::SendFragments(
+    const PipeInfo &pipeInfo, const std::string &networkId, const uint8_t *ptr, int size, uint32_t fragmentSize)
+{
+    uint32_t length = static_cast<uint32_t>(size);
+    FragmentHeader header;
+    header.nonce = msgNonce_;
+    header.count = PacketFragment::GetCount(length, fragmentSize);
+    header.totalLength = length;
+    header.msgId = nextMsgId_++;
+    LOG_INFO("send packet %{public}u in %{public}u fragments", header.msgId, header.count);
+    std::vector<uint8_t> buffer;
+    Status status = Status::SUCCESS;
+    uint32_t failures = 0;
+    // the receiver keeps what it holds of the packet across a session reopen, so a failed fragment is sent again
+    // under the same id and the packet resumes from it
+    for (header.index = 0; header.index < header.count;) {
+        fragmentWindow_.Acquire(networkId);
+        PacketFragment::Encode(ptr, length, fragmentSize, header, buffer);
+        status = SendBytesOnce(pipeInfo, networkId, buffer.data(), static_cast<int>(buffer.size()));
+        fragmentWindow_.Release(networkId);
+        if (status == Status::SUCCESS) {
+            header.index++;
+            failures = 0;
+            continue;
+        }
+        if (++failures >= MAX_RESEND_TIMES) {
+            LOG_ERROR("packet %{public}u stopped at fragment %{public}u", header.msgId, header.index);
+            break;
+        }
+        LOG_WARN("packet %{public}u resumes at fragment %{public}u", header.msgId, header.index);
     }
-    int state = GetSessionStatus(sessionId);
-    LOG_DEBUG("Waited for notification, state:%{public}d", state);
-    if (state != SOFTBUS_OK) {
-        LOG_ERROR("OpenSession callback result error");
+    return status;
+}
+
+Status SoftBusAdapter::SendBytesOnce(
+    const PipeInfo &pipeInfo, const std::string &networkId, const uint8_t *ptr, int size)
+{
+    int32_t sessionId = sessionPool_->Acquire(pipeInfo.pipeId, networkId);
+    if (sessionId < 0) {
         return Status::CREATE_SESSION_ERROR;
     }
-    LOG_DEBUG("[SendBytes] start,session id is %{public}d, size is %{public}d, "
-              "session type is %{public}d.",
-        sessionId, size, attr.dataType);
+    LOG_DEBUG("[SendBytes] start,session id is %{public}d, size is %{public}d.", sessionId, size);
     int32_t ret = SendBytes(sessionId, (void *)ptr, size);
+    sessionPool_->Release(pipeInfo.pipeId, networkId, sessionId, ret == SOFTBUS_OK);
     if (ret != SOFTBUS_OK) {
         LOG_ERROR("[SendBytes] to %{public}d failed, ret:%{public}d.", sessionId, ret);
         return Status::ERROR;
@@ -482,10 +605,53 @@ Status SoftBusAdapter::SendData(
     return Status::SUCCESS;
 }
 
-int32_t SoftBusAdapter::GetSessionStatus(int32_t sessionId)
+int32_t SoftBusAdapter::OpenSessionSync(
+    const std::string &pipeId, const std::string &networkId, const std::shared_ptr<CancellationToken> &token)
+{
+    SessionAttribute attr;
+    attr.dataType = TYPE_BYTES;
+    int sessionId = OpenSession(pipeId.c_str(), pipeId.c_str(), networkId.c_str(), "GROUP_ID", &attr);
+    if (sessionId < 0) {
+        LOG_WARN("OpenSession %{public}s failed, sessionId:%{public}d", pipeId.c_str(), sessionId);
+        return SessionPool::INVALID_SESSION;
+    }
+    int state = GetSessionStatus(sessionId, SESSION_OPEN_TIMEOUT, token);
+    LOG_DEBUG("Waited for notification, state:%{public}d", state);
+    if (state != SOFTBUS_OK) {
+        LOG_ERROR("OpenSession callback result error");
+        CloseSession(sessionId);
+        ClearSessionStatus(sessionId);
+        return SessionPool::INVALID_SESSION;
+    }
+    return sessionId;
+}
+
+int32_t SoftBusAdapter::GetSessionStatus(
+    int32_t sessionId, std::chrono::milliseconds timeout, const std::shared_ptr<CancellationToken> &token)
 {
     auto semaphore = GetSemaphore(sessionId);
-    return semaphore->Wait();
+    CancellationToken::CallbackId callbackId = CancellationToken::INVALID_CALLBACK_ID;
+    if (token != nullptr) {
+        callbackId = token->OnCancel([semaphore]() { semaphore->Notify(SOFTBUS_ERR); });
+    }
+    auto start = std::chrono::steady_clock::now();
+    int32_t status = SOFTBUS_ERR;
+    bool isNotified = semaphore->WaitFor(timeout, status);
+    if (token != nullptr) {
+        // the session pool keeps its token across opens
+        token->RemoveCallback(callbackId);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    if (!isNotified) {
+        LOG_ERROR("session %{public}d open timeout after %{public}lld ms", sessionId,
+            static_cast<long long>(elapsed.count()));
+        WaitStatistics::GetInstance().Record("open session", elapsed, WaitStatistics::TIMEOUT);
+        return SOFTBUS_ERR;
+    }
+    bool isCancelled = token != nullptr && token->IsCancelled();
+    WaitStatistics::GetInstance().Record(
+        "open session", elapsed, isCancelled ? WaitStatistics::CANCELED : WaitStatistics::COMPLETED);
+    return isCancelled ? SOFTBUS_ERR : status;
 }
 
 void SoftBusAdapter::OnSessionOpen(int32_t sessionId, int32_t status)
@@ -495,6 +661,80 @@ void SoftBusAdapter::OnSessionOpen(int32_t sessionId, int32_t status)
 }
 
 void SoftBusAdapter::OnSessionClose(int32_t sessionId)
+{
+    sessionPool_->OnClosed(sessionId);
+    ClearSessionStatus(sessionId);
+    ClearSessionPeer(sessionId);
+}
+
+bool SoftBusAdapter::OpenSessionPeer(int32_t sessionId, SessionPeer &peer)
+{
+    {
+        std::unique_lock<std::shared_mutex> lock(peerMutex_);
+        openingPeers_.insert(sessionId);
+    }
+    bool isKnown = QuerySessionPeer(sessionId, peer);
+    std::unique_lock<std::shared_mutex> lock(peerMutex_);
+    if (openingPeers_.erase(sessionId) == 0) {
+        // closed while SoftBus was asked, a late open must not bring the session back
+        LOG_WARN("session %{public}d closed while opening", sessionId);
+        return false;
+    }
+    if (isKnown) {
+        sessionPeers_[sessionId] = peer;
+    }
+    return isKnown;
+}
+
+bool SoftBusAdapter::GetSessionPeer(int32_t sessionId, SessionPeer &peer)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(peerMutex_);
+        auto it = sessionPeers_.find(sessionId);
+        if (it != sessionPeers_.end()) {
+            peer = it->second;
+            return true;
+        }
+    }
+    return QuerySessionPeer(sessionId, peer);
+}
+
+bool SoftBusAdapter::QuerySessionPeer(int32_t sessionId, SessionPeer &peer)
+{
+    char mySessionName[SESSION_NAME_SIZE_MAX] = "";
+    char peerSessionName[SESSION_NAME_SIZE_MAX] = "";
+    char peerDevId[DEVICE_ID_SIZE_MAX] = "";
+    int ret = GetMySessionName(sessionId, mySessionName, sizeof(mySessionName));
+    if (ret != SOFTBUS_OK) {
+        LOG_WARN("get my session name failed, session id is %{public}d.", sessionId);
+        return false;
+    }
+    ret = GetPeerSessionName(sessionId, peerSessionName, sizeof(peerSessionName));
+    if (ret != SOFTBUS_OK) {
+        LOG_WARN("get my peer session name failed, session id is %{public}d.", sessionId);
+        return false;
+    }
+    ret = GetPeerDeviceId(sessionId, peerDevId, sizeof(peerDevId));
+    if (ret != SOFTBUS_OK) {
+        LOG_WARN("get my peer device id failed, session id is %{public}d.", sessionId);
+        return false;
+    }
+    peer = { mySessionName, peerSessionName, GetUdidByNodeId(std::string(peerDevId)) };
+    if (peer.udid.empty()) {
+        LOG_WARN("no udid for the peer of session %{public}d.", sessionId);
+        return false;
+    }
+    return true;
+}
+
+void SoftBusAdapter::ClearSessionPeer(int32_t sessionId)
+{
+    std::unique_lock<std::shared_mutex> lock(peerMutex_);
+    sessionPeers_.erase(sessionId);
+    openingPeers_.erase(sessionId);
+}
+
+void SoftBusAdapter::ClearSessionStatus(int32_t sessionId)
 {
     lock_guard<mutex> lock(statusMutex_);
     auto it = sessionsStatus_.find(sessionId);
@@ -574,9 +814,10 @@ void SoftBusAdapter::NotifyDataListeners(
     const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo)
 {
     LOG_DEBUG("begin");
-    lock_guard<mutex> lock(dataChangeMutex_);
-    auto it = dataChangeListeners_.find(pipeInfo.pipeId);
-    if (it != dataChangeListeners_.end()) {
+    ReaderGate::Reader reader(listenerGate_);
+    auto listeners = std::atomic_load(&dataChangeListeners_);
+    auto it = listeners->find(pipeInfo.pipeId);
+    if (it != listeners->end()) {
         LOG_DEBUG("ready to notify, pipeName:%{public}s, deviceId:%{public}s.", pipeInfo.pipeId.c_str(),
             ToBeAnonymous(deviceId).c_str());
         DeviceInfo deviceInfo = { deviceId, "", "" };
@@ -586,6 +827,35 @@ void SoftBusAdapter::NotifyDataListeners(
     LOG_WARN("no listener %{public}s.", pipeInfo.pipeId.c_str());
 }
 
+void SoftBusAdapter::OnBytesReceived(
+    const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo)
+{
+    auto packet = std::make_shared<std::vector<uint8_t>>(ptr, ptr + size);
+    receivePool_->Post(deviceId, packet->size(), [this, packet, deviceId, pipeInfo]() {
+        HandleBytes(packet->data(), static_cast<int>(packet->size()), deviceId, pipeInfo);
+    });
+}
+
+void SoftBusAdapter::OnMessageReceived(
+    const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo)
+{
+    auto packet = std::make_shared<std::vector<uint8_t>>(ptr, ptr + size);
+    receivePool_->Post(deviceId, packet->size(), [this, packet, deviceId, pipeInfo]() {
+        NotifyDataListeners(packet->data(), static_cast<int>(packet->size()), deviceId, pipeInfo);
+    });
+}
+
+void SoftBusAdapter::HandleBytes(
+    const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo)
+{
+    auto deliver = [this, &deviceId, &pipeInfo](const uint8_t *data, uint32_t length) {
+        NotifyDataListeners(data, static_cast<int>(length), deviceId, pipeInfo);
+    };
+    if (!assembler_.Accept(deviceId, pipeInfo.pipeId, ptr, static_cast<uint32_t>(size), deliver)) {
+        NotifyDataListeners(ptr, size, deviceId, pipeInfo);
+    }
+}
+
 void AppDataListenerWrap::SetDataHandler(SoftBusAdapter *handler)
 {
     LOG_INFO("begin");
@@ -595,38 +865,23 @@ void AppDataListenerWrap::SetDataHandler(SoftBusAdapter *handler)
 int AppDataListenerWrap::OnSessionOpened(int sessionId, int result)
 {
     LOG_INFO("[SessionOpen] sessionId:%{public}d, result:%{public}d", sessionId, result);
-    char mySessionName[SESSION_NAME_SIZE_MAX] = "";
-    char peerSessionName[SESSION_NAME_SIZE_MAX] = "";
-    char peerDevId[DEVICE_ID_SIZE_MAX] = "";
     softBusAdapter_->OnSessionOpen(sessionId, result);
     if (result != SOFTBUS_OK) {
         LOG_WARN("session %{public}d open failed, result:%{public}d.", sessionId, result);
         return result;
     }
-    int ret = GetMySessionName(sessionId, mySessionName, sizeof(mySessionName));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my session name failed, session id is %{public}d.", sessionId);
-        return SOFTBUS_ERR;
-    }
-    ret = GetPeerSessionName(sessionId, peerSessionName, sizeof(peerSessionName));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer session name failed, session id is %{public}d.", sessionId);
+    SessionPeer peer;
+    if (!softBusAdapter_->OpenSessionPeer(sessionId, peer)) {
         return SOFTBUS_ERR;
     }
-    ret = GetPeerDeviceId(sessionId, peerDevId, sizeof(peerDevId));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer device id failed, session id is %{public}d.", sessionId);
-        return SOFTBUS_ERR;
-    }
-    std::string peerUdid = softBusAdapter_->GetUdidByNodeId(std::string(peerDevId));
     LOG_DEBUG("[SessionOpen] mySessionName:%{public}s, "
               "peerSessionName:%{public}s, peerDevId:%{public}s",
-        mySessionName, peerSessionName, SoftBusAdapter::ToBeAnonymous(peerUdid).c_str());
+        peer.mySessionName.c_str(), peer.peerSessionName.c_str(), SoftBusAdapter::ToBeAnonymous(peer.udid).c_str());
 
-    if (strlen(peerSessionName) < 1) {
-        softBusAdapter_->InsertSession(std::string(mySessionName) + peerUdid);
+    if (peer.peerSessionName.empty()) {
+        softBusAdapter_->InsertSession(peer.mySessionName + peer.udid);
     } else {
-        softBusAdapter_->InsertSession(std::string(peerSessionName) + peerUdid);
+        softBusAdapter_->InsertSession(peer.peerSessionName + peer.udid);
     }
     return 0;
 }
@@ -634,35 +889,21 @@ int AppDataListenerWrap::OnSessionOpened(int sessionId, int result)
 void AppDataListenerWrap::OnSessionClosed(int sessionId)
 {
     LOG_INFO("[SessionClosed] sessionId:%{public}d", sessionId);
-    char mySessionName[SESSION_NAME_SIZE_MAX] = "";
-    char peerSessionName[SESSION_NAME_SIZE_MAX] = "";
-    char peerDevId[DEVICE_ID_SIZE_MAX] = "";
-
+    SessionPeer peer;
+    bool isKnown = softBusAdapter_->GetSessionPeer(sessionId, peer);
+    // drops the cached peer as well
     softBusAdapter_->OnSessionClose(sessionId);
-    int ret = GetMySessionName(sessionId, mySessionName, sizeof(mySessionName));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my session name failed, session id is %{public}d.", sessionId);
+    if (!isKnown) {
         return;
     }
-    ret = GetPeerSessionName(sessionId, peerSessionName, sizeof(peerSessionName));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer session name failed, session id is %{public}d.", sessionId);
-        return;
-    }
-    ret = GetPeerDeviceId(sessionId, peerDevId, sizeof(peerDevId));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer device id failed, session id is %{public}d.", sessionId);
-        return;
-    }
-    std::string peerUdid = softBusAdapter_->GetUdidByNodeId(std::string(peerDevId));
     LOG_DEBUG("[SessionClosed] mySessionName:%{public}s, "
               "peerSessionName:%{public}s, peerDevId:%{public}s",
-        mySessionName, peerSessionName, SoftBusAdapter::ToBeAnonymous(peerUdid).c_str());
+        peer.mySessionName.c_str(), peer.peerSessionName.c_str(), SoftBusAdapter::ToBeAnonymous(peer.udid).c_str());
 
-    if (strlen(peerSessionName) < 1) {
-        softBusAdapter_->DeleteSession(std::string(mySessionName) + peerUdid);
+    if (peer.peerSessionName.empty()) {
+        softBusAdapter_->DeleteSession(peer.mySessionName + peer.udid);
     } else {
-        softBusAdapter_->DeleteSession(std::string(peerSessionName) + peerUdid);
+        softBusAdapter_->DeleteSession(peer.peerSessionName + peer.udid);
     }
 }
 
@@ -672,23 +913,15 @@ void AppDataListenerWrap::OnMessageReceived(int sessionId, const void *data, uns
     if (sessionId == INVALID_SESSION_ID) {
         return;
     }
-    char peerSessionName[SESSION_NAME_SIZE_MAX] = "";
-    char peerDevId[DEVICE_ID_SIZE_MAX] = "";
-    int ret = GetPeerSessionName(sessionId, peerSessionName, sizeof(peerSessionName));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer session name failed, session id is %{public}d.", sessionId);
+    SessionPeer peer;
+    if (!softBusAdapter_->GetSessionPeer(sessionId, peer)) {
         return;
     }
-    ret = GetPeerDeviceId(sessionId, peerDevId, sizeof(peerDevId));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer device id failed, session id is %{public}d.", sessionId);
-        return;
-    }
-    std::string peerUdid = softBusAdapter_->GetUdidByNodeId(std::string(peerDevId));
     LOG_DEBUG("[MessageReceived] session id:%{public}d, "
               "peerSessionName:%{public}s, peerDevId:%{public}s",
-        sessionId, peerSessionName, SoftBusAdapter::ToBeAnonymous(peerUdid).c_str());
-    NotifyDataListeners(reinterpret_cast<const uint8_t *>(data), dataLen, peerUdid, { std::string(peerSessionName) });
+        sessionId, peer.peerSessionName.c_str(), SoftBusAdapter::ToBeAnonymous(peer.udid).c_str());
+    softBusAdapter_->OnMessageReceived(
+        reinterpret_cast<const uint8_t *>(data), dataLen, peer.udid, { peer.peerSessionName });
 }
 
 void AppDataListenerWrap::OnBytesReceived(int sessionId, const void *data, unsigned int dataLen)
@@ -697,29 +930,15 @@ void AppDataListenerWrap::OnBytesReceived(int sessionId, const void *data, unsig
     if (sessionId == INVALID_SESSION_ID) {
         return;
     }
-    char peerSessionName[SESSION_NAME_SIZE_MAX] = "";
-    char peerDevId[DEVICE_ID_SIZE_MAX] = "";
-    int ret = GetPeerSessionName(sessionId, peerSessionName, sizeof(peerSessionName));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer session name failed, session id is %{public}d.", sessionId);
-        return;
-    }
-    ret = GetPeerDeviceId(sessionId, peerDevId, sizeof(peerDevId));
-    if (ret != SOFTBUS_OK) {
-        LOG_WARN("get my peer device id failed, session id is %{public}d.", sessionId);
+    SessionPeer peer;
+    if (!softBusAdapter_->GetSessionPeer(sessionId, peer)) {
         return;
     }
-    std::string peerUdid = softBusAdapter_->GetUdidByNodeId(std::string(peerDevId));
     LOG_DEBUG("[BytesReceived] session id:%{public}d, peerSessionName:%{public}s, "
               "peerDevId:%{public}s",
-        sessionId, peerSessionName, SoftBusAdapter::ToBeAnonymous(peerUdid).c_str());
-    NotifyDataListeners(reinterpret_cast<const uint8_t *>(data), dataLen, peerUdid, { std::string(peerSessionName) });
-}
-
-void AppDataListenerWrap::NotifyDataListeners(
-    const uint8_t *ptr, const int size, const std::string &deviceId, const PipeInfo &pipeInfo)
-{
-    return softBusAdapter_->NotifyDataListeners(ptr, size, deviceId, pipeInfo);
+        sessionId, peer.peerSessionName.c_str(), SoftBusAdapter::ToBeAnonymous(peer.udid).c_str());
+    softBusAdapter_->OnBytesReceived(
+        reinterpret_cast<const uint8_t *>(data), dataLen, peer.udid, { peer.peerSessionName });
 }
 } // namespace ObjectStore
 } // namespace OHOS
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <vector>
+#include "cancellation_token.h"
+#include "condition_lock.h"
+#include "reader_gate.h"
+#include "wait_statistics.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+class ConditionLockTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: ConditionLock_WaitFor_001
+ * @tc.desc: test that WaitFor gives up after the timeout and leaves the data untouched.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, ConditionLock_WaitFor_001, TestSize.Level1)
+{
+    constexpr std::chrono::milliseconds timeout = std::chrono::milliseconds(20);
+    ConditionLock<uint32_t> conditionLock;
+    uint32_t data = 1;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(conditionLock.WaitFor(timeout, data));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, timeout);
+    EXPECT_EQ(1u, data);
+}
+
+/**
+ * @tc.name: ConditionLock_WaitFor_002
+ * @tc.desc: test that WaitFor returns the data notified before or during the wait.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, ConditionLock_WaitFor_002, TestSize.Level1)
+{
+    constexpr std::chrono::seconds timeout = std::chrono::seconds(5);
+    ConditionLock<uint32_t> notified;
+    notified.Notify(2);
+    uint32_t data = 0;
+    EXPECT_TRUE(notified.WaitFor(timeout, data));
+    EXPECT_EQ(2u, data);
+
+    ConditionLock<uint32_t> conditionLock;
+    std::thread notifier([&conditionLock]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        conditionLock.Notify(3);
+    });
+    EXPECT_TRUE(conditionLock.WaitFor(timeout, data));
+    EXPECT_EQ(3u, data);
+    notifier.join();
+
+    conditionLock.Clear();
+    EXPECT_FALSE(conditionLock.WaitFor(std::chrono::milliseconds(1), data));
+}
+
+/**
+ * @tc.name: CancellationToken_001
+ * @tc.desc: test that cancel callbacks run once, and at once when registered after the cancel. a removed
+ *           callback does not run.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, CancellationToken_001, TestSize.Level1)
+{
+    CancellationToken token;
+    std::atomic<uint32_t> before = 0;
+    token.OnCancel([&before]() { before++; });
+    std::atomic<uint32_t> removed = 0;
+    token.RemoveCallback(token.OnCancel([&removed]() { removed++; }));
+    EXPECT_FALSE(token.IsCancelled());
+    EXPECT_EQ(0u, before);
+
+    token.Cancel();
+    token.Cancel();
+    EXPECT_TRUE(token.IsCancelled());
+    EXPECT_EQ(1u, before);
+    EXPECT_EQ(0u, removed);
+
+    std::atomic<uint32_t> after = 0;
+    EXPECT_EQ(CancellationToken::INVALID_CALLBACK_ID, token.OnCancel([&after]() { after++; }));
+    EXPECT_EQ(1u, after);
+}
+
+/**
+ * @tc.name: CancellationToken_002
+ * @tc.desc: test that a callback may register another one on the token it runs for.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, CancellationToken_002, TestSize.Level1)
+{
+    CancellationToken token;
+    std::atomic<uint32_t> count = 0;
+    token.OnCancel([&token, &count]() {
+        count++;
+        token.OnCancel([&count]() { count++; });
+    });
+    token.Cancel();
+    EXPECT_EQ(2u, count);
+}
+
+/**
+ * @tc.name: WaitStatistics_001
+ * @tc.desc: test that waits are counted by outcome and sorted into power of two buckets.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, WaitStatistics_001, TestSize.Level1)
+{
+    const std::string name = "condition lock test";
+    WaitStatistics &statistics = WaitStatistics::GetInstance();
+    statistics.Record(name, std::chrono::milliseconds(0), WaitStatistics::COMPLETED);
+    statistics.Record(name, std::chrono::milliseconds(5), WaitStatistics::TIMEOUT);
+    statistics.Record(name, std::chrono::hours(1), WaitStatistics::CANCELED);
+
+    WaitStatistics::Statistic statistic = statistics.Get(name);
+    EXPECT_EQ(1u, statistic.completed);
+    EXPECT_EQ(1u, statistic.timeout);
+    EXPECT_EQ(1u, statistic.canceled);
+    // 0 ms < 2^0, 4 <= 5 ms < 2^3, one hour in the last bucket
+    EXPECT_EQ(1u, statistic.histogram[0]);
+    EXPECT_EQ(1u, statistic.histogram[3]);
+    EXPECT_EQ(1u, statistic.histogram[WaitStatistics::BUCKET_SIZE - 1]);
+
+    WaitStatistics::Statistic unknown = statistics.Get("unknown wait");
+    EXPECT_EQ(0u, unknown.completed + unknown.timeout + unknown.canceled);
+}
+
+/**
+ * @tc.name: ReaderGate_001
+ * @tc.desc: test that Synchronize waits for the readers inside, but not for readers entering after it started.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, ReaderGate_001, TestSize.Level1)
+{
+    constexpr std::chrono::seconds timeout = std::chrono::seconds(5);
+    ReaderGate gate;
+    std::promise<void> entered;
+    std::promise<void> leave;
+    std::thread reader([&gate, &entered, &leave]() {
+        ReaderGate::Reader section(gate);
+        entered.set_value();
+        leave.get_future().wait();
+    });
+    entered.get_future().wait();
+    auto synchronized = std::async(std::launch::async, [&gate]() { gate.Synchronize(); });
+    EXPECT_EQ(std::future_status::timeout, synchronized.wait_for(std::chrono::milliseconds(20)));
+
+    // a reader coming after the writer does not hold it up
+    std::promise<void> lateLeave;
+    std::promise<void> lateEntered;
+    std::thread late([&gate, &lateEntered, &lateLeave]() {
+        ReaderGate::Reader section(gate);
+        lateEntered.set_value();
+        lateLeave.get_future().wait();
+    });
+    lateEntered.get_future().wait();
+    leave.set_value();
+    EXPECT_EQ(std::future_status::ready, synchronized.wait_for(timeout));
+    lateLeave.set_value();
+    reader.join();
+    late.join();
+}
+
+/**
+ * @tc.name: ReaderGate_002
+ * @tc.desc: test that Synchronize from inside a read section does not wait for the caller.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, ReaderGate_002, TestSize.Level1)
+{
+    constexpr std::chrono::seconds timeout = std::chrono::seconds(5);
+    ReaderGate gate;
+    auto synchronized = std::async(std::launch::async, [&gate]() {
+        ReaderGate::Reader outer(gate);
+        ReaderGate::Reader inner(gate);
+        gate.Synchronize();
+    });
+    EXPECT_EQ(std::future_status::ready, synchronized.wait_for(timeout));
+    gate.Synchronize();
+}
+
+/**
+ * @tc.name: ReaderGate_003
+ * @tc.desc: test that a snapshot freed after Synchronize is never read, with readers entering all the time.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ConditionLockTest, ReaderGate_003, TestSize.Level1)
+{
+    constexpr uint32_t readerCount = 4;
+    constexpr uint32_t replaceTimes = 1000;
+    ReaderGate gate;
+    std::atomic<uint32_t *> snapshot = new uint32_t(0);
+    std::atomic<bool> isRunning = true;
+    std::atomic<uint64_t> reads = 0;
+    std::vector<std::thread> readers;
+    for (uint32_t i = 0; i < readerCount; i++) {
+        readers.emplace_back([&gate, &snapshot, &isRunning, &reads]() {
+            while (isRunning) {
+                ReaderGate::Reader section(gate);
+                uint32_t *value = snapshot.load();
+                // let the writer replace the snapshot meanwhile, the old one must stay readable until we leave
+                std::this_thread::yield();
+                EXPECT_NE(UINT32_MAX, *value);
+                reads++;
+            }
+        });
+    }
+    // replace while the readers are in full swing
+    while (reads < readerCount) {
+        std::this_thread::yield();
+    }
+    for (uint32_t i = 1; i <= replaceTimes; i++) {
+        uint32_t *old = snapshot.exchange(new uint32_t(i));
+        gate.Synchronize();
+        // poisoned, so a reader still on it fails without a sanitizer too
+        *old = UINT32_MAX;
+        delete old;
+    }
+    isRunning = false;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    delete snapshot.load();
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "device_event_dispatcher.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+constexpr std::chrono::seconds WAIT_TIMEOUT = std::chrono::seconds(5);
+constexpr std::chrono::milliseconds WINDOW = std::chrono::milliseconds(100);
+
+struct Event {
+    std::string deviceId;
+    DeviceChangeType type;
+    bool isReconnect;
+};
+
+class EventRecorder {
+public:
+    DeviceEventDispatcher::Handler GetHandler()
+    {
+        return [this](const DeviceInfo &info, DeviceChangeType type, bool isReconnect) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.push_back({ info.deviceId, type, isReconnect });
+            cond_.notify_all();
+        };
+    }
+
+    // false if fewer than count events arrived within WAIT_TIMEOUT
+    bool WaitFor(size_t count, std::vector<Event> &events)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool isArrived = cond_.wait_for(lock, WAIT_TIMEOUT, [this, count]() { return events_.size() >= count; });
+        events = events_;
+        return isArrived;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Event> events_;
+};
+} // namespace
+
+class DeviceEventDispatcherTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: DeviceEventDispatcher_Order_001
+ * @tc.desc: test that devices are delivered in the order of their first event, with repeats folded.
+ * @tc.type: FUNC
+ */
+HWTEST_F(DeviceEventDispatcherTest, DeviceEventDispatcher_Order_001, TestSize.Level1)
+{
+    EventRecorder recorder;
+    DeviceEventDispatcher dispatcher(recorder.GetHandler(), WINDOW);
+    dispatcher.Post({ "device1", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+    dispatcher.Post({ "device2", "", "" }, DeviceChangeType::DEVICE_OFFLINE);
+    dispatcher.Post({ "device1", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+    dispatcher.Post({ "device3", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+
+    std::vector<Event> events;
+    ASSERT_TRUE(recorder.WaitFor(3, events));
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ("device1", events[0].deviceId);
+    EXPECT_EQ(DeviceChangeType::DEVICE_ONLINE, events[0].type);
+    EXPECT_FALSE(events[0].isReconnect);
+    EXPECT_EQ("device2", events[1].deviceId);
+    EXPECT_EQ(DeviceChangeType::DEVICE_OFFLINE, events[1].type);
+    EXPECT_EQ("device3", events[2].deviceId);
+}
+
+/**
+ * @tc.name: DeviceEventDispatcher_Flap_001
+ * @tc.desc: test that a device coming and going is dropped, and one going and coming back is a reconnect.
+ * @tc.type: FUNC
+ */
+HWTEST_F(DeviceEventDispatcherTest, DeviceEventDispatcher_Flap_001, TestSize.Level1)
+{
+    EventRecorder recorder;
+    DeviceEventDispatcher dispatcher(recorder.GetHandler(), WINDOW);
+    dispatcher.Post({ "came", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+    dispatcher.Post({ "came", "", "" }, DeviceChangeType::DEVICE_OFFLINE);
+    dispatcher.Post({ "back", "", "" }, DeviceChangeType::DEVICE_OFFLINE);
+    dispatcher.Post({ "back", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+    dispatcher.Post({ "bounced", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+    dispatcher.Post({ "bounced", "", "" }, DeviceChangeType::DEVICE_OFFLINE);
+    dispatcher.Post({ "bounced", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+    // delivered after every device above, a dropped event would have come before it
+    dispatcher.Post({ "last", "", "" }, DeviceChangeType::DEVICE_OFFLINE);
+
+    std::vector<Event> events;
+    ASSERT_TRUE(recorder.WaitFor(3, events));
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ("back", events[0].deviceId);
+    EXPECT_EQ(DeviceChangeType::DEVICE_ONLINE, events[0].type);
+    EXPECT_TRUE(events[0].isReconnect);
+    EXPECT_EQ("bounced", events[1].deviceId);
+    EXPECT_EQ(DeviceChangeType::DEVICE_ONLINE, events[1].type);
+    EXPECT_TRUE(events[1].isReconnect);
+    EXPECT_EQ("last", events[2].deviceId);
+    EXPECT_FALSE(events[2].isReconnect);
+}
+
+/**
+ * @tc.name: DeviceEventDispatcher_Window_001
+ * @tc.desc: test that events of a device posted after its window closed are delivered on their own.
+ * @tc.type: FUNC
+ */
+HWTEST_F(DeviceEventDispatcherTest, DeviceEventDispatcher_Window_001, TestSize.Level1)
+{
+    EventRecorder recorder;
+    DeviceEventDispatcher dispatcher(recorder.GetHandler(), WINDOW);
+    std::vector<Event> events;
+    dispatcher.Post({ "device", "", "" }, DeviceChangeType::DEVICE_ONLINE);
+    ASSERT_TRUE(recorder.WaitFor(1, events));
+    dispatcher.Post({ "device", "", "" }, DeviceChangeType::DEVICE_OFFLINE);
+    ASSERT_TRUE(recorder.WaitFor(2, events));
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ(DeviceChangeType::DEVICE_ONLINE, events[0].type);
+    EXPECT_EQ(DeviceChangeType::DEVICE_OFFLINE, events[1].type);
+}
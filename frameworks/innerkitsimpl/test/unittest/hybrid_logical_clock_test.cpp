@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include "hybrid_logical_clock.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+const std::string FIELD_KEY = "p_name";
+} // namespace
+
+class HybridLogicalClockTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: HybridLogicalClock_Tick_001
+ * @tc.desc: test that local versions grow and order after a version merged from a peer.
+ * @tc.type: FUNC
+ */
+HWTEST_F(HybridLogicalClockTest, HybridLogicalClock_Tick_001, TestSize.Level1)
+{
+    HybridLogicalClock clock;
+    clock.SetNodeId("local");
+    FieldVersion first = clock.Tick();
+    FieldVersion second = clock.Tick();
+    EXPECT_TRUE(first < second);
+    EXPECT_EQ(first.nodeId, clock.GetNodeId());
+
+    // a peer whose clock runs one hour ahead
+    constexpr uint64_t hour = 3600 * 1000;
+    FieldVersion remote = { second.physical + hour, 0, 1 };
+    clock.Update(remote);
+    EXPECT_TRUE(remote < clock.Tick());
+}
+
+/**
+ * @tc.name: FieldVersionCodec_001
+ * @tc.desc: test that versions are stored in their own entries and read back unchanged.
+ * @tc.type: FUNC
+ */
+HWTEST_F(HybridLogicalClockTest, FieldVersionCodec_001, TestSize.Level1)
+{
+    FieldVersion version = { 1650000000000, 7, 0x12345678 };
+    Bytes data = FieldVersionCodec::Encode(version);
+    EXPECT_EQ(FieldVersionCodec::ENCODED_SIZE, data.size());
+    FieldVersion decoded;
+    EXPECT_TRUE(FieldVersionCodec::Decode(data, decoded));
+    EXPECT_EQ(version, decoded);
+
+    data.push_back(0);
+    EXPECT_FALSE(FieldVersionCodec::Decode(data, decoded));
+    EXPECT_FALSE(FieldVersionCodec::Decode(Bytes(), decoded));
+
+    std::string versionKey = FieldVersionCodec::GetVersionKey(FIELD_KEY);
+    EXPECT_TRUE(FieldVersionCodec::IsVersionKey(versionKey));
+    EXPECT_FALSE(FieldVersionCodec::IsVersionKey(FIELD_KEY));
+}
+
+/**
+ * @tc.name: FieldVersionTable_Concurrent_001
+ * @tc.desc: test that two devices writing one field in the same millisecond pick the same winner.
+ * @tc.type: FUNC
+ */
+HWTEST_F(HybridLogicalClockTest, FieldVersionTable_Concurrent_001, TestSize.Level1)
+{
+    FieldVersion versionA = { 1650000000000, 0, 1 };
+    FieldVersion versionB = { 1650000000000, 0, 2 };
+    FieldVersionTable deviceA;
+    FieldVersionTable deviceB;
+    deviceA.Put(FIELD_KEY, versionA);
+    deviceB.Put(FIELD_KEY, versionB);
+
+    // each device receives the write of the other one
+    bool isAcceptedByA = deviceA.Resolve(FIELD_KEY, versionB);
+    bool isAcceptedByB = deviceB.Resolve(FIELD_KEY, versionA);
+    EXPECT_TRUE(isAcceptedByA);
+    EXPECT_FALSE(isAcceptedByB);
+
+    FieldVersion winnerA;
+    FieldVersion winnerB;
+    EXPECT_TRUE(deviceA.Get(FIELD_KEY, winnerA));
+    EXPECT_TRUE(deviceB.Get(FIELD_KEY, winnerB));
+    EXPECT_EQ(versionB, winnerA);
+    EXPECT_EQ(versionB, winnerB);
+
+    // the write back of the winner changes nothing on either device
+    EXPECT_TRUE(deviceA.Resolve(FIELD_KEY, versionB));
+    EXPECT_TRUE(deviceB.Resolve(FIELD_KEY, versionB));
+}
+
+/**
+ * @tc.name: FieldVersionTable_Stale_001
+ * @tc.desc: test that a late older write loses against a newer one and an unknown field takes any version.
+ * @tc.type: FUNC
+ */
+HWTEST_F(HybridLogicalClockTest, FieldVersionTable_Stale_001, TestSize.Level1)
+{
+    HybridLogicalClock clockA;
+    clockA.SetNodeId("deviceA");
+    HybridLogicalClock clockB;
+    clockB.SetNodeId("deviceB");
+    FieldVersion older = clockA.Tick();
+    clockB.Update(older);
+    FieldVersion newer = clockB.Tick();
+    EXPECT_TRUE(older < newer);
+
+    FieldVersionTable table;
+    EXPECT_TRUE(table.Resolve(FIELD_KEY, newer));
+    EXPECT_FALSE(table.Resolve(FIELD_KEY, older));
+    FieldVersion winner;
+    EXPECT_TRUE(table.Get(FIELD_KEY, winner));
+    EXPECT_EQ(newer, winner);
+
+    table.Remove(FIELD_KEY);
+    EXPECT_FALSE(table.Get(FIELD_KEY, winner));
+    EXPECT_TRUE(table.Resolve(FIELD_KEY, older));
+}
@@ -15,6 +15,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <future>
+#include <memory>
 #include <string>
 #include <thread>
 #include "distributed_object.h"
@@ -25,6 +28,14 @@ using namespace testing::ext;
 using namespace OHOS::ObjectStore;
 
 constexpr static double SALARY = 100.5;
+constexpr static std::chrono::seconds WAIT_TIMEOUT = std::chrono::seconds(10);
+
+class TestObjectWatcher : public ObjectWatcher {
+public:
+    void OnChanged(const std::string &sessionid, const std::vector<std::string> &changedData) override
+    {
+    }
+};
 
 static void TestSetSessionId(std::string bundleName, std::string sessionId)
 {
@@ -157,6 +168,41 @@ HWTEST_F(NativeObjectStoreTest, DistributedObjectStore_Watch_UnWatch_001, TestSi
     EXPECT_EQ(SUCCESS, ret);
 }
 
+/**
+ * @tc.name: DistributedObjectStore_Watch_UnWatch_002
+ * @tc.desc: test several watchers on one object.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObjectStore_Watch_UnWatch_002, TestSize.Level1)
+{
+    std::string bundleName = "default";
+    std::string sessionId = "123456";
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance(bundleName);
+    EXPECT_NE(nullptr, objectStore);
+
+    DistributedObject *object = objectStore->CreateObject(sessionId);
+    EXPECT_NE(nullptr, object);
+
+    auto firstWatcher = std::make_shared<TestObjectWatcher>();
+    auto secondWatcher = std::make_shared<TestObjectWatcher>();
+    uint32_t ret = objectStore->Watch(object, firstWatcher);
+    EXPECT_EQ(SUCCESS, ret);
+    ret = objectStore->Watch(object, secondWatcher);
+    EXPECT_EQ(SUCCESS, ret);
+    ret = objectStore->Watch(object, firstWatcher);
+    EXPECT_EQ(ERR_EXIST, ret);
+
+    ret = objectStore->UnWatch(object, firstWatcher);
+    EXPECT_EQ(SUCCESS, ret);
+    ret = objectStore->UnWatch(object, firstWatcher);
+    EXPECT_EQ(ERR_NO_OBSERVER, ret);
+    ret = objectStore->UnWatch(object);
+    EXPECT_EQ(SUCCESS, ret);
+
+    ret = objectStore->DeleteObject(sessionId);
+    EXPECT_EQ(SUCCESS, ret);
+}
+
 /**
  * @tc.name: DistributedObjectStore_SetStatusNotifier_001
  * @tc.desc: test DistributedObjectStore SetStatusNotifier.
@@ -354,4 +400,270 @@ HWTEST_F(NativeObjectStoreTest, DistributedObject_Save_RevokeSave_002, TestSize.
     t1.join();
     t2.join();
     t3.join();
-}
\ No newline at end of file
+}
+/**
+ * @tc.name: DistributedObject_Overwrite_001
+ * @tc.desc: test the latest write of a field is read back with its type.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObject_Overwrite_001, TestSize.Level1)
+{
+    std::string bundleName = "default";
+    std::string sessionId = "123456";
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance(bundleName);
+    EXPECT_NE(nullptr, objectStore);
+    DistributedObject *object = objectStore->CreateObject(sessionId);
+    EXPECT_NE(nullptr, object);
+
+    uint32_t ret = object->PutString("name", "zhangsan");
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->PutString("name", "lisi");
+    EXPECT_EQ(SUCCESS, ret);
+    std::string name = "";
+    ret = object->GetString("name", name);
+    EXPECT_EQ(SUCCESS, ret);
+    EXPECT_EQ("lisi", name);
+
+    ret = object->PutDouble("name", SALARY);
+    EXPECT_EQ(SUCCESS, ret);
+    Type type;
+    ret = object->GetType("name", type);
+    EXPECT_EQ(SUCCESS, ret);
+    EXPECT_EQ(TYPE_DOUBLE, type);
+    double value = 0.0;
+    ret = object->GetDouble("name", value);
+    EXPECT_EQ(SUCCESS, ret);
+    EXPECT_EQ(SALARY, value);
+
+    ret = objectStore->DeleteObject(sessionId);
+    EXPECT_EQ(SUCCESS, ret);
+}
+
+/**
+ * @tc.name: DistributedObject_Save_Again_001
+ * @tc.desc: test saving the whole object again after changing one field.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObject_Save_Again_001, TestSize.Level1)
+{
+    std::string bundleName = "default";
+    std::string sessionId = "123456";
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance(bundleName);
+    EXPECT_NE(nullptr, objectStore);
+    DistributedObject *object = objectStore->CreateObject(sessionId);
+    EXPECT_NE(nullptr, object);
+
+    uint32_t ret = object->PutString("name", "zhangsan");
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->PutDouble("salary", SALARY);
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->Save("local");
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->PutString("name", "lisi");
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->Save("local");
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->RevokeSave();
+    EXPECT_EQ(SUCCESS, ret);
+
+    ret = objectStore->DeleteObject(sessionId);
+    EXPECT_EQ(SUCCESS, ret);
+}
+
+/**
+ * @tc.name: DistributedObjectStore_GetInstance_001
+ * @tc.desc: test that every bundle gets its own store.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObjectStore_GetInstance_001, TestSize.Level1)
+{
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance("default");
+    EXPECT_NE(nullptr, objectStore);
+    EXPECT_EQ(objectStore, DistributedObjectStore::GetInstance("default"));
+    DistributedObjectStore *otherStore = DistributedObjectStore::GetInstance("other");
+    EXPECT_NE(nullptr, otherStore);
+    EXPECT_NE(objectStore, otherStore);
+
+    std::string sessionId = "123456";
+    DistributedObject *object = objectStore->CreateObject(sessionId);
+    EXPECT_NE(nullptr, object);
+    DistributedObject *otherObject = nullptr;
+    uint32_t ret = otherStore->Get(sessionId, &otherObject);
+    EXPECT_EQ(ERR_GET_OBJECT, ret);
+
+    ret = objectStore->DeleteObject(sessionId);
+    EXPECT_EQ(SUCCESS, ret);
+}
+
+/**
+ * @tc.name: DistributedObjectStore_SaveAll_001
+ * @tc.desc: test saving and retrieving several objects in one call.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObjectStore_SaveAll_001, TestSize.Level1)
+{
+    std::string bundleName = "default";
+    std::vector<std::string> sessionIds = { "session1", "session2" };
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance(bundleName);
+    EXPECT_NE(nullptr, objectStore);
+    for (auto &sessionId : sessionIds) {
+        DistributedObject *object = objectStore->CreateObject(sessionId);
+        EXPECT_NE(nullptr, object);
+        uint32_t ret = object->PutString("name", sessionId);
+        EXPECT_EQ(SUCCESS, ret);
+    }
+
+    // the callback may still come after a timed out wait, it owns the promise
+    auto saved = std::make_shared<std::promise<std::map<std::string, uint32_t>>>();
+    auto savedFuture = saved->get_future();
+    uint32_t ret = objectStore->SaveAll(sessionIds, "local",
+        [saved](const std::map<std::string, uint32_t> &results) { saved->set_value(results); });
+    EXPECT_EQ(SUCCESS, ret);
+    ASSERT_EQ(std::future_status::ready, savedFuture.wait_for(WAIT_TIMEOUT));
+    std::map<std::string, uint32_t> results = savedFuture.get();
+    EXPECT_EQ(sessionIds.size(), results.size());
+    for (auto &item : results) {
+        EXPECT_EQ(SUCCESS, item.second);
+    }
+
+    auto retrieved = std::make_shared<std::promise<std::map<std::string, uint32_t>>>();
+    auto retrievedFuture = retrieved->get_future();
+    ret = objectStore->RetrieveAll(sessionIds,
+        [retrieved](const std::map<std::string, uint32_t> &results) { retrieved->set_value(results); });
+    EXPECT_EQ(SUCCESS, ret);
+    ASSERT_EQ(std::future_status::ready, retrievedFuture.wait_for(WAIT_TIMEOUT));
+    results = retrievedFuture.get();
+    EXPECT_EQ(sessionIds.size(), results.size());
+
+    for (auto &sessionId : sessionIds) {
+        DistributedObject *object = nullptr;
+        ret = objectStore->Get(sessionId, &object);
+        EXPECT_EQ(SUCCESS, ret);
+        ret = object->RevokeSave();
+        EXPECT_EQ(SUCCESS, ret);
+        ret = objectStore->DeleteObject(sessionId);
+        EXPECT_EQ(SUCCESS, ret);
+    }
+}
+
+/**
+ * @tc.name: DistributedObjectStore_TriggerSync_001
+ * @tc.desc: test pushing every changed object in one call.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObjectStore_TriggerSync_001, TestSize.Level1)
+{
+    std::string bundleName = "default";
+    std::vector<std::string> sessionIds = { "session1", "session2" };
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance(bundleName);
+    EXPECT_NE(nullptr, objectStore);
+    for (auto &sessionId : sessionIds) {
+        DistributedObject *object = objectStore->CreateObject(sessionId);
+        EXPECT_NE(nullptr, object);
+        uint32_t ret = object->PutString("name", sessionId);
+        EXPECT_EQ(SUCCESS, ret);
+    }
+
+    auto pushed = std::make_shared<std::promise<std::map<std::string, uint32_t>>>();
+    auto pushedFuture = pushed->get_future();
+    uint32_t ret = objectStore->TriggerSync(
+        [pushed](const std::map<std::string, uint32_t> &results) { pushed->set_value(results); });
+    EXPECT_EQ(SUCCESS, ret);
+    ASSERT_EQ(std::future_status::ready, pushedFuture.wait_for(WAIT_TIMEOUT));
+    std::map<std::string, uint32_t> results = pushedFuture.get();
+    // no peer is online in the test environment, every changed session waits for the next push
+    for (auto &sessionId : sessionIds) {
+        ASSERT_EQ(1, results.count(sessionId));
+        EXPECT_EQ(ERR_SINGLE_DEVICE, results[sessionId]);
+    }
+
+    pushed = std::make_shared<std::promise<std::map<std::string, uint32_t>>>();
+    pushedFuture = pushed->get_future();
+    ret = objectStore->TriggerSync(
+        [pushed](const std::map<std::string, uint32_t> &results) { pushed->set_value(results); });
+    EXPECT_EQ(SUCCESS, ret);
+    ASSERT_EQ(std::future_status::ready, pushedFuture.wait_for(WAIT_TIMEOUT));
+    results = pushedFuture.get();
+    for (auto &sessionId : sessionIds) {
+        ASSERT_EQ(1, results.count(sessionId));
+        EXPECT_EQ(ERR_SINGLE_DEVICE, results[sessionId]);
+    }
+
+    for (auto &sessionId : sessionIds) {
+        ret = objectStore->DeleteObject(sessionId);
+        EXPECT_EQ(SUCCESS, ret);
+    }
+}
+
+/**
+ * @tc.name: DistributedObject_Save_Devices_001
+ * @tc.desc: test saving one object to several devices.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObject_Save_Devices_001, TestSize.Level1)
+{
+    std::string bundleName = "default";
+    std::string sessionId = "123456";
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance(bundleName);
+    EXPECT_NE(nullptr, objectStore);
+    DistributedObject *object = objectStore->CreateObject(sessionId);
+    EXPECT_NE(nullptr, object);
+
+    uint32_t ret = object->PutString("name", "zhangsan");
+    EXPECT_EQ(SUCCESS, ret);
+    std::map<std::string, int32_t> results;
+    ret = object->Save(std::vector<std::string>{}, results);
+    EXPECT_EQ(ERR_INVALID_ARGS, ret);
+    ret = object->Save(std::vector<std::string>{ "local" }, results);
+    EXPECT_EQ(SUCCESS, ret);
+    EXPECT_EQ(1u, results.size());
+    EXPECT_EQ(SUCCESS, results["local"]);
+    ret = object->RevokeSave();
+    EXPECT_EQ(SUCCESS, ret);
+
+    ret = objectStore->DeleteObject(sessionId);
+    EXPECT_EQ(SUCCESS, ret);
+}
+
+/**
+ * @tc.name: DistributedObject_Save_Large_001
+ * @tc.desc: test that an object of several hundred KB is saved in one request and retrieved whole.
+ * @tc.type: FUNC
+ */
+HWTEST_F(NativeObjectStoreTest, DistributedObject_Save_Large_001, TestSize.Level1)
+{
+    std::string bundleName = "default";
+    std::string sessionId = "123456";
+    constexpr size_t FIELD_SIZE = 150 * 1024;
+    DistributedObjectStore *objectStore = DistributedObjectStore::GetInstance(bundleName);
+    EXPECT_NE(nullptr, objectStore);
+    DistributedObject *object = objectStore->CreateObject(sessionId);
+    ASSERT_NE(nullptr, object);
+
+    std::vector<uint8_t> picture1(FIELD_SIZE, 'a');
+    std::vector<uint8_t> picture2(FIELD_SIZE, 'b');
+    uint32_t ret = object->PutComplex("picture1", picture1);
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->PutComplex("picture2", picture2);
+    EXPECT_EQ(SUCCESS, ret);
+    ret = object->Save("local");
+    EXPECT_EQ(SUCCESS, ret);
+
+    // the object created again under the same session retrieves the saved copy on first access
+    ret = objectStore->DeleteObject(sessionId);
+    EXPECT_EQ(SUCCESS, ret);
+    object = objectStore->CreateObject(sessionId);
+    ASSERT_NE(nullptr, object);
+    std::vector<uint8_t> value;
+    ret = object->GetComplex("picture1", value);
+    EXPECT_EQ(SUCCESS, ret);
+    EXPECT_EQ(picture1, value);
+    ret = object->GetComplex("picture2", value);
+    EXPECT_EQ(SUCCESS, ret);
+    EXPECT_EQ(picture2, value);
+    ret = object->RevokeSave();
+    EXPECT_EQ(SUCCESS, ret);
+
+    ret = objectStore->DeleteObject(sessionId);
+    EXPECT_EQ(SUCCESS, ret);
+}
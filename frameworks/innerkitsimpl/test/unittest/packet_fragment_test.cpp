@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "packet_fragment.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+constexpr uint32_t FRAGMENT_SIZE = 16;
+const std::string DEVICE = "device";
+const std::string PIPE = "pipe";
+
+std::vector<std::vector<uint8_t>> MakeFragments(const std::vector<uint8_t> &packet, uint32_t msgId, uint32_t nonce = 1)
+{
+    FragmentHeader header;
+    header.nonce = nonce;
+    header.msgId = msgId;
+    header.totalLength = static_cast<uint32_t>(packet.size());
+    header.count = PacketFragment::GetCount(header.totalLength, FRAGMENT_SIZE);
+    std::vector<std::vector<uint8_t>> fragments(header.count);
+    for (header.index = 0; header.index < header.count; header.index++) {
+        PacketFragment::Encode(packet.data(), header.totalLength, FRAGMENT_SIZE, header, fragments[header.index]);
+    }
+    return fragments;
+}
+
+std::vector<uint8_t> MakePacket(uint32_t length)
+{
+    std::vector<uint8_t> packet(length);
+    for (uint32_t i = 0; i < length; i++) {
+        packet[i] = static_cast<uint8_t>(i);
+    }
+    return packet;
+}
+} // namespace
+
+class PacketFragmentTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: PacketFragment_Assemble_001
+ * @tc.desc: test that fragments received in order give the packet back once, and other packets are not taken.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PacketFragmentTest, PacketFragment_Assemble_001, TestSize.Level1)
+{
+    std::vector<uint8_t> packet = MakePacket(FRAGMENT_SIZE * 3 + 1);
+    auto fragments = MakeFragments(packet, 0);
+    ASSERT_EQ(4u, fragments.size());
+    FragmentAssembler assembler;
+    std::vector<std::vector<uint8_t>> delivered;
+    auto deliver = [&delivered](const uint8_t *data, uint32_t length) { delivered.emplace_back(data, data + length); };
+    for (auto &fragment : fragments) {
+        EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, fragment.data(), fragment.size(), deliver));
+    }
+    ASSERT_EQ(1u, delivered.size());
+    EXPECT_EQ(packet, delivered[0]);
+    EXPECT_EQ(0u, assembler.GetPendingBytes());
+
+    std::vector<uint8_t> plain = MakePacket(FRAGMENT_SIZE);
+    EXPECT_FALSE(assembler.Accept(DEVICE, PIPE, plain.data(), plain.size(), deliver));
+    EXPECT_EQ(1u, delivered.size());
+}
+
+/**
+ * @tc.name: PacketFragment_Gap_001
+ * @tc.desc: test that a missing fragment drops the packet and a repeated one is ignored.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PacketFragmentTest, PacketFragment_Gap_001, TestSize.Level1)
+{
+    std::vector<uint8_t> packet = MakePacket(FRAGMENT_SIZE * 3);
+    FragmentAssembler assembler;
+    uint32_t delivered = 0;
+    auto deliver = [&delivered](const uint8_t *, uint32_t) { delivered++; };
+
+    auto gap = MakeFragments(packet, 0);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, gap[0].data(), gap[0].size(), deliver));
+    EXPECT_EQ(packet.size(), assembler.GetPendingBytes());
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, gap[2].data(), gap[2].size(), deliver));
+    EXPECT_EQ(0u, assembler.GetPendingBytes());
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, gap[1].data(), gap[1].size(), deliver));
+    EXPECT_EQ(0u, delivered);
+
+    auto repeated = MakeFragments(packet, 1);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, repeated[0].data(), repeated[0].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, repeated[1].data(), repeated[1].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, repeated[1].data(), repeated[1].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, repeated[2].data(), repeated[2].size(), deliver));
+    EXPECT_EQ(1u, delivered);
+}
+
+/**
+ * @tc.name: PacketFragment_Nonce_001
+ * @tc.desc: test that a restarted sender counting message ids again does not continue the packet it left.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PacketFragmentTest, PacketFragment_Nonce_001, TestSize.Level1)
+{
+    std::vector<uint8_t> packet = MakePacket(FRAGMENT_SIZE * 2);
+    FragmentAssembler assembler;
+    std::vector<std::vector<uint8_t>> delivered;
+    auto deliver = [&delivered](const uint8_t *data, uint32_t length) { delivered.emplace_back(data, data + length); };
+    auto before = MakeFragments(packet, 0, 1);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, before[0].data(), before[0].size(), deliver));
+
+    auto after = MakeFragments(packet, 0, 2);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, after[0].data(), after[0].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, after[1].data(), after[1].size(), deliver));
+    ASSERT_EQ(1u, delivered.size());
+    EXPECT_EQ(packet, delivered[0]);
+}
+
+/**
+ * @tc.name: PacketFragment_Timeout_001
+ * @tc.desc: test that a packet without a new fragment within the timeout is dropped.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PacketFragmentTest, PacketFragment_Timeout_001, TestSize.Level1)
+{
+    constexpr std::chrono::milliseconds timeout = std::chrono::milliseconds(10);
+    std::vector<uint8_t> packet = MakePacket(FRAGMENT_SIZE * 2);
+    FragmentAssembler assembler(timeout);
+    uint32_t delivered = 0;
+    auto deliver = [&delivered](const uint8_t *, uint32_t) { delivered++; };
+    auto fragments = MakeFragments(packet, 0);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, fragments[0].data(), fragments[0].size(), deliver));
+    std::this_thread::sleep_for(timeout * 2);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, fragments[1].data(), fragments[1].size(), deliver));
+    EXPECT_EQ(0u, delivered);
+    EXPECT_EQ(0u, assembler.GetPendingBytes());
+}
+
+/**
+ * @tc.name: PacketFragment_Limit_001
+ * @tc.desc: test that packets beyond the pending bytes are refused until a device is cleared.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PacketFragmentTest, PacketFragment_Limit_001, TestSize.Level1)
+{
+    std::vector<uint8_t> packet = MakePacket(FRAGMENT_SIZE * 2);
+    FragmentAssembler assembler(FragmentAssembler::REASSEMBLY_TIMEOUT, packet.size() * 2);
+    uint32_t delivered = 0;
+    auto deliver = [&delivered](const uint8_t *, uint32_t) { delivered++; };
+    auto first = MakeFragments(packet, 0);
+    auto second = MakeFragments(packet, 1);
+    auto third = MakeFragments(packet, 2);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, first[0].data(), first[0].size(), deliver));
+    EXPECT_TRUE(assembler.Accept("other", PIPE, second[0].data(), second[0].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, third[0].data(), third[0].size(), deliver));
+    EXPECT_EQ(packet.size() * 2, assembler.GetPendingBytes());
+
+    assembler.Clear("other");
+    EXPECT_EQ(packet.size(), assembler.GetPendingBytes());
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, third[0].data(), third[0].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, third[1].data(), third[1].size(), deliver));
+    EXPECT_EQ(1u, delivered);
+
+    assembler.Clear(DEVICE);
+    EXPECT_EQ(0u, assembler.GetPendingBytes());
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, first[1].data(), first[1].size(), deliver));
+    EXPECT_EQ(1u, delivered);
+}
+
+/**
+ * @tc.name: PacketFragment_Resume_001
+ * @tc.desc: test that a packet resumed at the fragment that failed is delivered once and whole.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PacketFragmentTest, PacketFragment_Resume_001, TestSize.Level1)
+{
+    std::vector<uint8_t> packet = MakePacket(FRAGMENT_SIZE * 3);
+    FragmentAssembler assembler;
+    std::vector<std::vector<uint8_t>> delivered;
+    auto deliver = [&delivered](const uint8_t *data, uint32_t length) { delivered.emplace_back(data, data + length); };
+    auto fragments = MakeFragments(packet, 0);
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, fragments[0].data(), fragments[0].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, fragments[1].data(), fragments[1].size(), deliver));
+    // the sender did not see the second fragment acknowledged and sends it again on a reopened session
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, fragments[1].data(), fragments[1].size(), deliver));
+    EXPECT_TRUE(assembler.Accept(DEVICE, PIPE, fragments[2].data(), fragments[2].size(), deliver));
+    ASSERT_EQ(1u, delivered.size());
+    EXPECT_EQ(packet, delivered[0]);
+    EXPECT_EQ(0u, assembler.GetPendingBytes());
+}
+
+/**
+ * @tc.name: PacketFragment_Window_001
+ * @tc.desc: test that a device never has more fragments in flight than the window, and other devices are not held.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PacketFragmentTest, PacketFragment_Window_001, TestSize.Level1)
+{
+    constexpr uint32_t WINDOW_SIZE = 2;
+    constexpr uint32_t SENDERS = 4;
+    FragmentWindow window(WINDOW_SIZE);
+    window.Acquire(DEVICE);
+    window.Acquire(DEVICE);
+    EXPECT_EQ(WINDOW_SIZE, window.GetInFlight(DEVICE));
+    window.Acquire("other");
+    EXPECT_EQ(1u, window.GetInFlight("other"));
+    window.Release("other");
+    window.Release(DEVICE);
+    window.Release(DEVICE);
+    EXPECT_EQ(0u, window.GetInFlight(DEVICE));
+
+    std::atomic<uint32_t> inFlight = 0;
+    std::atomic<uint32_t> maxInFlight = 0;
+    std::vector<std::thread> senders;
+    for (uint32_t i = 0; i < SENDERS; i++) {
+        senders.emplace_back([&window, &inFlight, &maxInFlight]() {
+            for (uint32_t j = 0; j < FRAGMENT_SIZE; j++) {
+                window.Acquire(DEVICE);
+                uint32_t current = ++inFlight;
+                uint32_t seen = maxInFlight.load();
+                while (current > seen && !maxInFlight.compare_exchange_weak(seen, current)) {
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                inFlight--;
+                window.Release(DEVICE);
+            }
+        });
+    }
+    for (auto &sender : senders) {
+        sender.join();
+    }
+    EXPECT_LE(maxInFlight.load(), WINDOW_SIZE);
+    EXPECT_EQ(0u, window.GetInFlight(DEVICE));
+}
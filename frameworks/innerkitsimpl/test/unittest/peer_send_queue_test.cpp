@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "peer_send_queue.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+constexpr std::chrono::seconds WAIT_TIMEOUT = std::chrono::seconds(5);
+} // namespace
+
+class PeerSendQueueTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: PeerSendQueue_Order_001
+ * @tc.desc: test that the packets of one peer go out in order on one worker that is not the caller.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PeerSendQueueTest, PeerSendQueue_Order_001, TestSize.Level1)
+{
+    constexpr uint8_t packets = 20;
+    std::mutex mutex;
+    std::vector<uint8_t> sent;
+    std::vector<std::thread::id> threads;
+    std::promise<void> finished;
+    PeerSendQueue queue([&](const std::string &, const std::vector<uint8_t> &data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sent.push_back(data[0]);
+        threads.push_back(std::this_thread::get_id());
+        if (sent.size() == packets) {
+            finished.set_value();
+        }
+        return true;
+    }, packets, PeerSendQueue::MAX_QUEUE_BYTES);
+    for (uint8_t i = 0; i < packets; i++) {
+        ASSERT_EQ(PeerSendQueue::QUEUED, queue.Push("peer", &i, sizeof(i)));
+    }
+    auto future = finished.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint8_t i = 0; i < packets; i++) {
+        EXPECT_EQ(i, sent[i]);
+        EXPECT_EQ(threads[0], threads[i]);
+    }
+    EXPECT_NE(std::this_thread::get_id(), threads[0]);
+}
+
+/**
+ * @tc.name: PeerSendQueue_Full_001
+ * @tc.desc: test that a blocked peer fills only its own queue and does not hold back another peer, and that a
+ *           removed peer keeps its worker only until the packet being sent is done.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PeerSendQueueTest, PeerSendQueue_Full_001, TestSize.Level1)
+{
+    constexpr size_t maxSize = 2;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> blocking;
+    std::promise<void> otherSent;
+    PeerSendQueue queue([&](const std::string &peer, const std::vector<uint8_t> &data) {
+        if (peer == "other") {
+            otherSent.set_value();
+            return true;
+        }
+        if (data[0] == 0) {
+            blocking.set_value();
+            released.wait();
+        }
+        return true;
+    }, maxSize, PeerSendQueue::MAX_QUEUE_BYTES);
+    uint8_t data[] = { 0, 1, 2, 3 };
+    ASSERT_EQ(PeerSendQueue::QUEUED, queue.Push("slow", &data[0], 1));
+    auto sending = blocking.get_future();
+    ASSERT_EQ(std::future_status::ready, sending.wait_for(WAIT_TIMEOUT));
+    EXPECT_EQ(PeerSendQueue::QUEUED, queue.Push("slow", &data[1], 1));
+    EXPECT_EQ(PeerSendQueue::QUEUED, queue.Push("slow", &data[2], 1));
+    EXPECT_EQ(PeerSendQueue::QUEUE_FULL, queue.Push("slow", &data[3], 1));
+    EXPECT_EQ(maxSize, queue.GetDepth("slow"));
+
+    EXPECT_EQ(PeerSendQueue::QUEUED, queue.Push("other", &data[0], 1));
+    auto other = otherSent.get_future();
+    EXPECT_EQ(std::future_status::ready, other.wait_for(WAIT_TIMEOUT));
+
+    queue.Remove("slow");
+    EXPECT_EQ(0u, queue.GetDepth("slow"));
+    EXPECT_EQ(2u, queue.GetPeerCount());
+    release.set_value();
+    // the worker of the removed peer goes once its last packet is sent
+    auto deadline = std::chrono::steady_clock::now() + WAIT_TIMEOUT;
+    while (queue.GetPeerCount() != 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(1u, queue.GetPeerCount());
+}
+
+/**
+ * @tc.name: PeerSendQueue_Broken_001
+ * @tc.desc: test that a failed send drops the packets behind it and is reported once by the next push.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PeerSendQueueTest, PeerSendQueue_Broken_001, TestSize.Level1)
+{
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<uint32_t> sends = 0;
+    auto failed = std::make_shared<std::promise<void>>();
+    auto resent = std::make_shared<std::promise<void>>();
+    PeerSendQueue queue([&](const std::string &, const std::vector<uint8_t> &data) {
+        sends++;
+        if (data[0] == 0) {
+            released.wait();
+            failed->set_value();
+            return false;
+        }
+        if (data[0] == 2) {
+            resent->set_value();
+        }
+        return true;
+    });
+    uint8_t data[] = { 0, 1, 2 };
+    ASSERT_EQ(PeerSendQueue::QUEUED, queue.Push("peer", &data[0], 1));
+    ASSERT_EQ(PeerSendQueue::QUEUED, queue.Push("peer", &data[1], 1));
+    release.set_value();
+    auto future = failed->get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+    // the failure is recorded right after the sender returned
+    while (queue.GetDepth("peer") != 0) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(PeerSendQueue::PEER_BROKEN, queue.Push("peer", &data[2], 1));
+    EXPECT_EQ(PeerSendQueue::QUEUED, queue.Push("peer", &data[2], 1));
+    auto next = resent->get_future();
+    ASSERT_EQ(std::future_status::ready, next.wait_for(WAIT_TIMEOUT));
+    EXPECT_EQ(2u, sends);
+}
+
+/**
+ * @tc.name: PeerSendQueue_Lifetime_001
+ * @tc.desc: test that destroying the queue waits for the packet being sent and drops the rest.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PeerSendQueueTest, PeerSendQueue_Lifetime_001, TestSize.Level1)
+{
+    std::promise<void> blocking;
+    std::atomic<uint32_t> sends = 0;
+    std::atomic<bool> isSending = false;
+    auto queue = std::make_unique<PeerSendQueue>([&](const std::string &, const std::vector<uint8_t> &data) {
+        sends++;
+        if (data[0] == 0) {
+            isSending = true;
+            blocking.set_value();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            isSending = false;
+        }
+        return true;
+    });
+    uint8_t data[] = { 0, 1 };
+    ASSERT_EQ(PeerSendQueue::QUEUED, queue->Push("peer", &data[0], 1));
+    ASSERT_EQ(PeerSendQueue::QUEUED, queue->Push("peer", &data[1], 1));
+    auto sending = blocking.get_future();
+    ASSERT_EQ(std::future_status::ready, sending.wait_for(WAIT_TIMEOUT));
+    queue = nullptr;
+    EXPECT_FALSE(isSending);
+    EXPECT_EQ(1u, sends);
+}
+
+/**
+ * @tc.name: PeerSendQueue_Idle_001
+ * @tc.desc: test that a peer idle for the timeout loses its queue and gets a new one with the next push.
+ * @tc.type: FUNC
+ */
+HWTEST_F(PeerSendQueueTest, PeerSendQueue_Idle_001, TestSize.Level1)
+{
+    constexpr std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(10);
+    std::atomic<uint32_t> sends = 0;
+    PeerSendQueue queue([&sends](const std::string &, const std::vector<uint8_t> &) {
+        sends++;
+        return true;
+    }, PeerSendQueue::MAX_QUEUE_SIZE, PeerSendQueue::MAX_QUEUE_BYTES, idleTimeout);
+    uint8_t data = 0;
+    ASSERT_EQ(PeerSendQueue::QUEUED, queue.Push("peer", &data, 1));
+    EXPECT_EQ(1u, queue.GetPeerCount());
+    auto deadline = std::chrono::steady_clock::now() + WAIT_TIMEOUT;
+    while (queue.GetPeerCount() != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(0u, queue.GetPeerCount());
+    EXPECT_EQ(1u, sends);
+
+    ASSERT_EQ(PeerSendQueue::QUEUED, queue.Push("peer", &data, 1));
+    deadline = std::chrono::steady_clock::now() + WAIT_TIMEOUT;
+    while (sends != 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(2u, sends);
+}
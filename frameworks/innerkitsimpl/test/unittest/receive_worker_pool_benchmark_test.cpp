@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "receive_worker_pool.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+constexpr std::chrono::seconds WAIT_TIMEOUT = std::chrono::seconds(5);
+constexpr std::chrono::microseconds HANDLE_LATENCY = std::chrono::microseconds(500);
+constexpr uint32_t PEER_COUNT = 8;
+constexpr uint32_t PACKETS_PER_PEER = 50;
+constexpr size_t PACKET_SIZE = 1024;
+
+std::string PeerName(uint32_t index)
+{
+    return "peer" + std::to_string(index);
+}
+
+// stands in for the DistributedDB receive handler, every packet costs HANDLE_LATENCY
+void HandlePacket(const std::vector<uint8_t> &)
+{
+    std::this_thread::sleep_for(HANDLE_LATENCY);
+}
+
+// packets of all peers arrive interleaved on one SoftBus callback thread, returns packets handled per second
+double RunReceives(const std::function<void(const std::string &peer, std::shared_ptr<std::vector<uint8_t>>)> &receive,
+    const std::function<bool()> &isDone)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < PACKETS_PER_PEER; i++) {
+        for (uint32_t peer = 0; peer < PEER_COUNT; peer++) {
+            receive(PeerName(peer), std::make_shared<std::vector<uint8_t>>(PACKET_SIZE));
+        }
+    }
+    while (!isDone()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return PEER_COUNT * PACKETS_PER_PEER / seconds;
+}
+} // namespace
+
+class ReceiveWorkerPoolBenchmarkTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: ReceiveWorkerPool_Order_001
+ * @tc.desc: test that packets of one peer are handled in the order they were posted.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ReceiveWorkerPoolBenchmarkTest, ReceiveWorkerPool_Order_001, TestSize.Level1)
+{
+    constexpr uint32_t packets = 1000;
+    std::mutex mutex;
+    std::map<std::string, std::vector<uint32_t>> handled;
+    std::atomic<uint32_t> count = 0;
+    {
+        ReceiveWorkerPool pool(3);
+        for (uint32_t i = 0; i < packets; i++) {
+            std::string peer = PeerName(i % PEER_COUNT);
+            pool.Post(peer, 1, [&mutex, &handled, &count, peer, i]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                handled[peer].push_back(i);
+                count++;
+            });
+        }
+        while (count < packets) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    EXPECT_EQ(PEER_COUNT, handled.size());
+    for (auto &item : handled) {
+        EXPECT_TRUE(std::is_sorted(item.second.begin(), item.second.end()));
+    }
+}
+
+/**
+ * @tc.name: ReceiveWorkerPool_Bound_001
+ * @tc.desc: test that a peer holding too many bytes has its packets dropped and counted without waiting, while
+ *           other peers on the same worker are still taken.
+ * @tc.type: FUNC
+ */
+HWTEST_F(ReceiveWorkerPoolBenchmarkTest, ReceiveWorkerPool_Bound_001, TestSize.Level1)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool isReleased = false;
+    uint32_t count = 0;
+    auto handle = [&mutex, &cond, &count]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        count++;
+        cond.notify_all();
+    };
+    ReceiveWorkerPool pool(1, PACKET_SIZE);
+    EXPECT_TRUE(pool.Post("slow", PACKET_SIZE, [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&isReleased]() { return isReleased; });
+        count++;
+        cond.notify_all();
+    }));
+    // returns at once while the first packet holds the worker
+    EXPECT_FALSE(pool.Post("slow", PACKET_SIZE, handle));
+    EXPECT_EQ(1u, pool.GetDropped("slow"));
+    EXPECT_TRUE(pool.Post("slow", 0, handle));
+    EXPECT_TRUE(pool.Post("other", PACKET_SIZE, handle));
+    EXPECT_EQ(0u, pool.GetDropped("other"));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        isReleased = true;
+        cond.notify_all();
+        EXPECT_TRUE(cond.wait_for(lock, WAIT_TIMEOUT, [&count]() { return count == 3; }));
+    }
+    EXPECT_TRUE(pool.Post("slow", PACKET_SIZE, handle));
+    EXPECT_EQ(1u, pool.GetDropped("slow"));
+}
+
+/**
+ * @tc.name: ReceiveWorkerPool_Benchmark_001
+ * @tc.desc: compare packets handled on the callback thread with packets handed to the worker pool.
+ * @tc.type: PERF
+ */
+HWTEST_F(ReceiveWorkerPoolBenchmarkTest, ReceiveWorkerPool_Benchmark_001, TestSize.Level1)
+{
+    double inlineRate = RunReceives(
+        [](const std::string &, std::shared_ptr<std::vector<uint8_t>> packet) { HandlePacket(*packet); },
+        []() { return true; });
+
+    std::atomic<uint32_t> handled = 0;
+    double pooledRate = 0;
+    {
+        ReceiveWorkerPool pool;
+        pooledRate = RunReceives(
+            [&pool, &handled](const std::string &peer, std::shared_ptr<std::vector<uint8_t>> packet) {
+                pool.Post(peer, packet->size(), [packet, &handled]() {
+                    HandlePacket(*packet);
+                    handled++;
+                });
+            },
+            [&handled]() { return handled == PEER_COUNT * PACKETS_PER_PEER; });
+    }
+
+    printf("%u peers, handled on callback thread: %.0f packets/s\n", PEER_COUNT, inlineRate);
+    printf("%u peers, %zu receive workers:        %.0f packets/s\n", PEER_COUNT,
+        ReceiveWorkerPool::DEFAULT_WORKERS, pooledRate);
+    // throughput depends on the machine, it is reported rather than compared
+    printf("speedup: %.2fx\n", inlineRate > 0 ? pooledRate / inlineRate : 0);
+}
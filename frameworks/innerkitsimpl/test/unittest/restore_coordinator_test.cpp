@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "objectstore_errors.h"
+#include "restore_coordinator.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+constexpr std::chrono::seconds WAIT_TIMEOUT = std::chrono::seconds(5);
+constexpr std::chrono::milliseconds SHORT_BACKOFF = std::chrono::milliseconds(1);
+} // namespace
+
+class RestoreCoordinatorTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: RestoreCoordinator_Restore_001
+ * @tc.desc: test that the notifier runs once, after the last pull answered on a thread of its own.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RestoreCoordinatorTest, RestoreCoordinator_Restore_001, TestSize.Level1)
+{
+    std::mutex mutex;
+    std::vector<RestoreCoordinator::SyncDone> pulls;
+    auto sync = [&mutex, &pulls](const std::string &sessionId, const RestoreCoordinator::SyncDone &done) {
+        if (sessionId == "single") {
+            return ERR_SINGLE_DEVICE;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        pulls.push_back(done);
+        return SUCCESS;
+    };
+    std::atomic<uint32_t> notified = 0;
+    std::atomic<uint32_t> result = ERR_SYNC_FAIL;
+    auto notifier = [&notified, &result](uint32_t status) {
+        result = status;
+        notified++;
+    };
+    auto coordinator = std::make_shared<RestoreCoordinator>(sync, notifier, SHORT_BACKOFF);
+    coordinator->Start({ "session1", "session2", "single" });
+    ASSERT_EQ(2u, pulls.size());
+    EXPECT_EQ(0u, notified);
+
+    pulls[0](true);
+    EXPECT_EQ(0u, notified);
+    std::thread answer([&pulls]() { pulls[1](true); });
+    answer.join();
+    EXPECT_EQ(1u, notified);
+    EXPECT_EQ(SUCCESS, result);
+    // a late duplicate answer changes nothing
+    pulls[1](true);
+    EXPECT_EQ(1u, notified);
+}
+
+/**
+ * @tc.name: RestoreCoordinator_Restore_002
+ * @tc.desc: test that nothing to restore notifies at once.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RestoreCoordinatorTest, RestoreCoordinator_Restore_002, TestSize.Level1)
+{
+    std::atomic<uint32_t> calls = 0;
+    auto sync = [&calls](const std::string &, const RestoreCoordinator::SyncDone &) {
+        calls++;
+        return SUCCESS;
+    };
+    std::atomic<uint32_t> notified = 0;
+    auto notifier = [&notified](uint32_t status) {
+        EXPECT_EQ(SUCCESS, status);
+        notified++;
+    };
+    auto coordinator = std::make_shared<RestoreCoordinator>(sync, notifier, SHORT_BACKOFF);
+    coordinator->Start({});
+    EXPECT_EQ(1u, notified);
+    EXPECT_EQ(0u, calls);
+}
+
+/**
+ * @tc.name: RestoreCoordinator_Retry_001
+ * @tc.desc: test that failed pulls are retried on the scheduler until one succeeds.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RestoreCoordinatorTest, RestoreCoordinator_Retry_001, TestSize.Level1)
+{
+    constexpr uint32_t failures = 2;
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+    auto sync = [&mutex, &threads](const std::string &, const RestoreCoordinator::SyncDone &done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.push_back(std::this_thread::get_id());
+        if (threads.size() == 1) {
+            return ERR_DB_GET_FAIL;
+        }
+        // the second attempt starts and then fails, the third one succeeds
+        done(threads.size() > failures);
+        return SUCCESS;
+    };
+    auto finished = std::make_shared<std::promise<uint32_t>>();
+    auto future = finished->get_future();
+    auto coordinator = std::make_shared<RestoreCoordinator>(
+        sync, [finished](uint32_t status) { finished->set_value(status); }, SHORT_BACKOFF);
+    coordinator->Start({ "session" });
+    ASSERT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+    EXPECT_EQ(SUCCESS, future.get());
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(failures + 1, threads.size());
+    EXPECT_EQ(std::this_thread::get_id(), threads[0]);
+    EXPECT_NE(std::this_thread::get_id(), threads[1]);
+}
+
+/**
+ * @tc.name: RestoreCoordinator_Retry_002
+ * @tc.desc: test that a session failing every attempt ends the restore after the last retry.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RestoreCoordinatorTest, RestoreCoordinator_Retry_002, TestSize.Level1)
+{
+    std::atomic<uint32_t> attempts = 0;
+    auto sync = [&attempts](const std::string &, const RestoreCoordinator::SyncDone &) {
+        attempts++;
+        return ERR_DB_GET_FAIL;
+    };
+    auto finished = std::make_shared<std::promise<uint32_t>>();
+    auto future = finished->get_future();
+    auto coordinator = std::make_shared<RestoreCoordinator>(
+        sync, [finished](uint32_t status) { finished->set_value(status); }, SHORT_BACKOFF);
+    coordinator->Start({ "session" });
+    ASSERT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+    EXPECT_EQ(ERR_SYNC_FAIL, future.get());
+    EXPECT_EQ(RestoreCoordinator::MAX_RETRY_TIMES, attempts);
+
+    // a deleted session is not retried
+    attempts = 0;
+    std::atomic<uint32_t> result = SUCCESS;
+    auto deleted = std::make_shared<RestoreCoordinator>(
+        [&attempts](const std::string &, const RestoreCoordinator::SyncDone &) {
+            attempts++;
+            return ERR_DB_NOT_EXIST;
+        },
+        [&result](uint32_t status) { result = status; }, SHORT_BACKOFF);
+    deleted->Start({ "session" });
+    EXPECT_EQ(1u, attempts);
+    EXPECT_EQ(ERR_SYNC_FAIL, result);
+}
+
+/**
+ * @tc.name: RestoreCoordinator_Timeout_001
+ * @tc.desc: test that a pull still running at the timeout ends the restore with ERR_TIMEOUT, once.
+ * @tc.type: FUNC
+ */
+HWTEST_F(RestoreCoordinatorTest, RestoreCoordinator_Timeout_001, TestSize.Level1)
+{
+    constexpr std::chrono::milliseconds timeout = std::chrono::milliseconds(50);
+    std::mutex mutex;
+    std::vector<RestoreCoordinator::SyncDone> pulls;
+    auto sync = [&mutex, &pulls](const std::string &sessionId, const RestoreCoordinator::SyncDone &done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (sessionId == "answered") {
+            done(true);
+            return SUCCESS;
+        }
+        // never answers before the timeout
+        pulls.push_back(done);
+        return SUCCESS;
+    };
+    std::atomic<uint32_t> notified = 0;
+    auto finished = std::make_shared<std::promise<uint32_t>>();
+    auto future = finished->get_future();
+    auto notifier = [&notified, finished](uint32_t status) {
+        if (notified++ == 0) {
+            finished->set_value(status);
+        }
+    };
+    auto coordinator = std::make_shared<RestoreCoordinator>(sync, notifier, SHORT_BACKOFF, timeout);
+    coordinator->Start({ "answered", "silent" });
+    ASSERT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+    EXPECT_EQ(ERR_TIMEOUT, future.get());
+
+    // the answer after the timeout notifies nothing more
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(1u, pulls.size());
+    pulls[0](true);
+    EXPECT_EQ(1u, notified);
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include "session_pool.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+constexpr std::chrono::milliseconds OPEN_LATENCY = std::chrono::milliseconds(5);
+constexpr uint32_t SEND_TIMES = 200;
+
+// stands in for SoftBus, opening a session costs OPEN_LATENCY and sending is free
+class StubSoftBus {
+public:
+    int32_t Open(const std::string &, const std::string &)
+    {
+        uint32_t current = ++opening_;
+        uint32_t peak = maxOpening_;
+        while (current > peak && !maxOpening_.compare_exchange_weak(peak, current)) {
+        }
+        std::this_thread::sleep_for(OPEN_LATENCY);
+        opening_--;
+        opened_++;
+        return nextId_++;
+    }
+    void Close(int32_t)
+    {
+        closed_++;
+    }
+    SessionPool::Opener Opener()
+    {
+        return [this](const std::string &pipeId, const std::string &peer,
+                   const std::shared_ptr<CancellationToken> &) { return Open(pipeId, peer); };
+    }
+    SessionPool::Closer Closer()
+    {
+        return [this](int32_t sessionId) { Close(sessionId); };
+    }
+    std::atomic<uint32_t> opened_ = 0;
+    std::atomic<uint32_t> closed_ = 0;
+    std::atomic<uint32_t> maxOpening_ = 0;
+
+private:
+    std::atomic<uint32_t> opening_ = 0;
+    std::atomic<int32_t> nextId_ = 1;
+};
+
+struct BenchmarkResult {
+    double sendsPerSecond = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+};
+
+BenchmarkResult RunSends(const std::function<void()> &send)
+{
+    std::vector<double> latencies;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < SEND_TIMES; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        send();
+        latencies.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::sort(latencies.begin(), latencies.end());
+    BenchmarkResult result;
+    result.sendsPerSecond = SEND_TIMES / seconds;
+    result.p50Us = latencies[latencies.size() / 2];
+    result.p99Us = latencies[latencies.size() * 99 / 100];
+    return result;
+}
+} // namespace
+
+class SessionPoolBenchmarkTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: SessionPool_Reuse_001
+ * @tc.desc: test that a pooled session is reused and closed after repeated send failures.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SessionPoolBenchmarkTest, SessionPool_Reuse_001, TestSize.Level1)
+{
+    StubSoftBus softBus;
+    auto pool = std::make_shared<SessionPool>(softBus.Opener(), softBus.Closer());
+    int32_t sessionId = pool->Acquire("pipe", "peer");
+    EXPECT_GE(sessionId, 0);
+    pool->Release("pipe", "peer", sessionId, true);
+    EXPECT_EQ(sessionId, pool->Acquire("pipe", "peer"));
+    EXPECT_EQ(1, softBus.opened_.load());
+    EXPECT_NE(sessionId, pool->Acquire("pipe", "other"));
+    EXPECT_EQ(2, pool->Size());
+
+    for (uint32_t i = 0; i < SessionPool::MAX_FAILURES; i++) {
+        pool->Release("pipe", "peer", sessionId, false);
+    }
+    EXPECT_EQ(1, softBus.closed_.load());
+    EXPECT_NE(sessionId, pool->Acquire("pipe", "peer"));
+
+    pool->OnClosed(sessionId);
+    pool->Clear();
+    EXPECT_EQ(0, pool->Size());
+}
+
+/**
+ * @tc.name: SessionPool_Idle_001
+ * @tc.desc: test that idle sessions are closed and concurrent opens stay under the cap.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SessionPoolBenchmarkTest, SessionPool_Idle_001, TestSize.Level1)
+{
+    StubSoftBus softBus;
+    constexpr uint32_t maxOpening = 2;
+    auto pool = std::make_shared<SessionPool>(
+        softBus.Opener(), softBus.Closer(), std::chrono::milliseconds(50), maxOpening);
+    std::vector<std::thread> senders;
+    for (int i = 0; i < 8; i++) {
+        senders.emplace_back([pool, i]() { pool->Acquire("pipe", "peer" + std::to_string(i)); });
+    }
+    for (auto &sender : senders) {
+        sender.join();
+    }
+    EXPECT_EQ(8, pool->Size());
+    EXPECT_LE(softBus.maxOpening_.load(), maxOpening);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    pool->CloseIdle();
+    EXPECT_EQ(0, pool->Size());
+    EXPECT_EQ(8, softBus.closed_.load());
+}
+
+/**
+ * @tc.name: SessionPool_Reaper_001
+ * @tc.desc: test that idle sessions are closed without being asked and the idle check does not hold up the pool
+ *           going away.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SessionPoolBenchmarkTest, SessionPool_Reaper_001, TestSize.Level1)
+{
+    constexpr std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(20);
+    constexpr std::chrono::seconds waitTimeout = std::chrono::seconds(5);
+    StubSoftBus softBus;
+    auto pool = std::make_shared<SessionPool>(softBus.Opener(), softBus.Closer(), idleTimeout);
+    EXPECT_GE(pool->Acquire("pipe", "peer"), 0);
+    auto deadline = std::chrono::steady_clock::now() + waitTimeout;
+    while (pool->Size() != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(0, pool->Size());
+    EXPECT_EQ(1, softBus.closed_.load());
+
+    pool = std::make_shared<SessionPool>(softBus.Opener(), softBus.Closer(), std::chrono::hours(1));
+    EXPECT_GE(pool->Acquire("pipe", "peer"), 0);
+    auto start = std::chrono::steady_clock::now();
+    pool = nullptr;
+    EXPECT_LT(std::chrono::steady_clock::now() - start, waitTimeout);
+    EXPECT_EQ(2, softBus.closed_.load());
+}
+
+/**
+ * @tc.name: SessionPool_Cancel_001
+ * @tc.desc: test that clearing the pool cancels an open still waiting for SoftBus.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SessionPoolBenchmarkTest, SessionPool_Cancel_001, TestSize.Level1)
+{
+    constexpr std::chrono::seconds waitTimeout = std::chrono::seconds(5);
+    std::promise<void> opening;
+    auto opener = [&opening, waitTimeout](const std::string &, const std::string &,
+                      const std::shared_ptr<CancellationToken> &token) {
+        auto cancelled = std::make_shared<std::promise<void>>();
+        token->OnCancel([cancelled]() { cancelled->set_value(); });
+        opening.set_value();
+        // stands in for SoftBus never answering the open
+        cancelled->get_future().wait_for(waitTimeout);
+        return token->IsCancelled() ? SessionPool::INVALID_SESSION : 1;
+    };
+    std::atomic<uint32_t> closed = 0;
+    auto pool = std::make_shared<SessionPool>(opener, [&closed](int32_t) { closed++; });
+    auto start = std::chrono::steady_clock::now();
+    auto sessionId = std::async(std::launch::async, [pool]() { return pool->Acquire("pipe", "peer"); });
+    ASSERT_EQ(std::future_status::ready, opening.get_future().wait_for(waitTimeout));
+    pool->Clear();
+    EXPECT_EQ(SessionPool::INVALID_SESSION, sessionId.get());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, waitTimeout);
+    EXPECT_EQ(0, pool->Size());
+    EXPECT_EQ(0u, closed);
+}
+
+/**
+ * @tc.name: SessionPool_Benchmark_001
+ * @tc.desc: compare sends opening a session each time with sends through the pool.
+ * @tc.type: PERF
+ */
+HWTEST_F(SessionPoolBenchmarkTest, SessionPool_Benchmark_001, TestSize.Level1)
+{
+    StubSoftBus softBus;
+    BenchmarkResult unpooled = RunSends([&softBus]() {
+        int32_t sessionId = softBus.Open("pipe", "peer");
+        softBus.Close(sessionId);
+    });
+
+    auto pool = std::make_shared<SessionPool>(softBus.Opener(), softBus.Closer());
+    BenchmarkResult pooled = RunSends([&pool]() {
+        int32_t sessionId = pool->Acquire("pipe", "peer");
+        pool->Release("pipe", "peer", sessionId, true);
+    });
+
+    printf("open per send: %.0f sends/s, p50 %.1f us, p99 %.1f us\n", unpooled.sendsPerSecond, unpooled.p50Us,
+        unpooled.p99Us);
+    printf("pooled:        %.0f sends/s, p50 %.1f us, p99 %.1f us\n", pooled.sendsPerSecond, pooled.p50Us,
+        pooled.p99Us);
+    EXPECT_GT(pooled.sendsPerSecond, unpooled.sendsPerSecond);
+    EXPECT_LT(pooled.p50Us, unpooled.p50Us);
+}
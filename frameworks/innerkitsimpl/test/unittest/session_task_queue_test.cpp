@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "session_task_queue.h"
+
+using namespace testing::ext;
+using namespace OHOS::ObjectStore;
+
+namespace {
+constexpr std::chrono::seconds WAIT_TIMEOUT = std::chrono::seconds(5);
+} // namespace
+
+class SessionTaskQueueTest : public testing::Test {
+public:
+    static void SetUpTestCase(void){};
+    static void TearDownTestCase(void){};
+    void SetUp(){};
+    void TearDown(){};
+};
+
+/**
+ * @tc.name: SessionTaskQueue_Order_001
+ * @tc.desc: test that tasks of one session run one at a time in order when answered from other threads.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SessionTaskQueueTest, SessionTaskQueue_Order_001, TestSize.Level1)
+{
+    constexpr uint32_t tasks = 20;
+    std::mutex mutex;
+    std::vector<uint32_t> started;
+    uint32_t running = 0;
+    uint32_t maxRunning = 0;
+    std::vector<std::thread> answers;
+    std::promise<void> finished;
+    SessionTaskQueue queue;
+    for (uint32_t i = 0; i < tasks; i++) {
+        queue.Schedule("session", [&, i](const std::function<void()> &done) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                started.push_back(i);
+                running++;
+                maxRunning = std::max(maxRunning, running);
+                // the service answers later on a thread of its own
+                answers.emplace_back([&mutex, &running, &finished, done, i]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        running--;
+                    }
+                    done();
+                    if (i + 1 == tasks) {
+                        finished.set_value();
+                    }
+                });
+            }
+        });
+    }
+    auto future = finished.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+    for (auto &answer : answers) {
+        answer.join();
+    }
+    ASSERT_EQ(tasks, started.size());
+    for (uint32_t i = 0; i < tasks; i++) {
+        EXPECT_EQ(i, started[i]);
+    }
+    EXPECT_EQ(1u, maxRunning);
+}
+
+/**
+ * @tc.name: SessionTaskQueue_Sessions_001
+ * @tc.desc: test that a session waiting for its answer does not hold back another session.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SessionTaskQueueTest, SessionTaskQueue_Sessions_001, TestSize.Level1)
+{
+    std::function<void()> blockedDone;
+    std::promise<void> otherRan;
+    SessionTaskQueue queue;
+    queue.Schedule("blocked", [&blockedDone](const std::function<void()> &done) { blockedDone = done; });
+    queue.Schedule("other", [&otherRan](const std::function<void()> &done) {
+        otherRan.set_value();
+        done();
+    });
+    auto future = otherRan.get_future();
+    EXPECT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+
+    std::promise<void> nextRan;
+    queue.Schedule("blocked", [&nextRan](const std::function<void()> &done) {
+        nextRan.set_value();
+        done();
+    });
+    auto next = nextRan.get_future();
+    EXPECT_EQ(std::future_status::timeout, next.wait_for(std::chrono::milliseconds(50)));
+    blockedDone();
+    EXPECT_EQ(std::future_status::ready, next.wait_for(WAIT_TIMEOUT));
+}
+
+/**
+ * @tc.name: SessionTaskQueue_Worker_001
+ * @tc.desc: test that tasks failing synchronously neither recurse nor run on the thread that finished the last one.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SessionTaskQueueTest, SessionTaskQueue_Worker_001, TestSize.Level1)
+{
+    constexpr uint32_t tasks = 10000;
+    std::mutex mutex;
+    std::map<std::thread::id, uint32_t> threads;
+    uint32_t count = 0;
+    std::promise<void> finished;
+    SessionTaskQueue queue;
+    for (uint32_t i = 0; i < tasks; i++) {
+        queue.Schedule("session", [&](const std::function<void()> &done) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                threads[std::this_thread::get_id()]++;
+                if (++count == tasks) {
+                    finished.set_value();
+                }
+            }
+            done();
+        });
+    }
+    auto future = finished.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(WAIT_TIMEOUT));
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(1u, threads.size());
+    EXPECT_EQ(0u, threads.count(std::this_thread::get_id()));
+}
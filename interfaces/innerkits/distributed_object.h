@@ -20,6 +20,8 @@
 #include <string>
 #include <vector>
 
+#include "objectstore_errors.h"
+
 namespace OHOS::ObjectStore {
 enum Type : uint8_t {
     TYPE_STRING = 0,
@@ -42,6 +44,12 @@ public:
     virtual uint32_t Save(const std::string &deviceId) = 0;
     virtual uint32_t RevokeSave() = 0;
     virtual std::string &GetSessionId() = 0;
+    // saves the same snapshot to every device, results holds the status of each one.
+    // ERR_NOT_SUPPORTED unless an implementation overrides it
+    virtual uint32_t Save(const std::vector<std::string> &deviceIds, std::map<std::string, int32_t> &results)
+    {
+        return ERR_NOT_SUPPORTED;
+    }
 };
 
 class ObjectWatcher {
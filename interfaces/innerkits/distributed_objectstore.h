@@ -15,11 +15,15 @@
 
 #ifndef DISTRIBUTED_OBJECTSTORE_H
 #define DISTRIBUTED_OBJECTSTORE_H
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "distributed_object.h"
+#include "objectstore_errors.h"
 
 namespace OHOS::ObjectStore {
 class StatusNotifier {
@@ -35,10 +39,39 @@ public:
     virtual uint32_t Get(const std::string &sessionId, DistributedObject **object) = 0;
     virtual uint32_t DeleteObject(const std::string &sessionId) = 0;
     virtual uint32_t Watch(DistributedObject *object, std::shared_ptr<ObjectWatcher> objectWatcher) = 0;
+    // several watchers may watch one object, this removes all of them
     virtual uint32_t UnWatch(DistributedObject *object) = 0;
     virtual uint32_t SetStatusNotifier(std::shared_ptr<StatusNotifier> notifier) = 0;
     virtual void TriggerSync();
     virtual void TriggerRestore(std::function<void()> notifier);
+    // the calls below came later, they answer ERR_NOT_SUPPORTED unless an implementation overrides them
+    virtual uint32_t UnWatch(DistributedObject *object, std::shared_ptr<ObjectWatcher> objectWatcher)
+    {
+        return ERR_NOT_SUPPORTED;
+    }
+    // saves several objects at once, results are keyed by session id and reported in one callback
+    virtual uint32_t SaveAll(const std::vector<std::string> &sessionIds, const std::string &deviceId,
+        const std::function<void(const std::map<std::string, uint32_t> &results)> &callback)
+    {
+        return ERR_NOT_SUPPORTED;
+    }
+    virtual uint32_t RetrieveAll(const std::vector<std::string> &sessionIds,
+        const std::function<void(const std::map<std::string, uint32_t> &results)> &callback)
+    {
+        return ERR_NOT_SUPPORTED;
+    }
+    // pushes every object changed since its last push to all online devices, results are keyed by session id
+    virtual uint32_t TriggerSync(const std::function<void(const std::map<std::string, uint32_t> &results)> &callback)
+    {
+        return ERR_NOT_SUPPORTED;
+    }
+    // pulls every object from the other devices, the notifier gets SUCCESS, ERR_SYNC_FAIL or,
+    // when the pulls still run after timeout, ERR_TIMEOUT
+    virtual uint32_t TriggerRestore(
+        std::chrono::milliseconds timeout, const std::function<void(uint32_t status)> &notifier)
+    {
+        return ERR_NOT_SUPPORTED;
+    }
 };
 } // namespace OHOS::ObjectStore
 
@@ -41,6 +41,11 @@ constexpr uint32_t ERR_UNRIGSTER = BASE_ERR_OFFSET + 16;
 constexpr uint32_t ERR_SINGLE_DEVICE = BASE_ERR_OFFSET + 17;
 constexpr uint32_t ERR_NULL_PTR = BASE_ERR_OFFSET + 18;
 constexpr uint32_t ERR_PROCESSING = BASE_ERR_OFFSET + 19;
+constexpr uint32_t ERR_TIMEOUT = BASE_ERR_OFFSET + 20;
+constexpr uint32_t ERR_CANCELED = BASE_ERR_OFFSET + 21;
+constexpr uint32_t ERR_INVALID_ARGS = BASE_ERR_OFFSET + 22;
+constexpr uint32_t ERR_SYNC_FAIL = BASE_ERR_OFFSET + 23;
+constexpr uint32_t ERR_NOT_SUPPORTED = BASE_ERR_OFFSET + 24;
 } // namespace OHOS::ObjectStore
 
 #endif